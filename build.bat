@@ -1,2 +1,6 @@
     g++ -std=c++23 -O2 -Wall -Ilibs/include -Llibs/lib @(Get-ChildItem src -Recurse -Filter *.cpp | ForEach-Object { $_.FullName }) -lSDL3 -lSDL3_image -lSDL3_ttf -o build\mummymaze.exe
+    g++ -std=c++23 -O2 -Wall tools/pack_assets.cpp -o build\pack_assets.exe
+    g++ -std=c++23 -O2 -Wall tools/wav_adpcm.cpp -o build\wav_adpcm.exe
+    g++ -std=c++23 -O2 -Wall -Ilibs/include -Llibs/lib tools/bench_userstore.cpp src/userstore.cpp src/leaderboard.cpp src/assets.cpp src/jobs.cpp -lSDL3 -lSDL3_image -lSDL3_ttf -o build\bench_userstore.exe
+    build\pack_assets.exe assets assets.pak
     build\mummymaze.exe
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "arena.h"
+#include <algorithm>
+
+LevelArena::~LevelArena() { release(); }
+
+void* LevelArena::allocate(size_t size, size_t align)
+{
+    // fits in the current chunk?
+    if (current < chunks.size()) {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(chunks[current].data);
+        const size_t start = ((base + offset + align - 1) & ~(uintptr_t)(align - 1)) - base;
+        if (start + size <= chunks[current].size) {
+            stats.bytes += start + size - offset;
+            stats.peakBytes = std::max(stats.peakBytes, stats.bytes);
+            offset = start + size;
+            return chunks[current].data + start;
+        }
+        stats.bytes += chunks[current].size - offset; // the tail of this chunk stays unused
+        ++current;
+    }
+
+    // next kept chunk big enough (a large one may have been added for an earlier level),
+    // otherwise a new one; smaller kept chunks are skipped for this level
+    const size_t need = size + align;
+    while (current < chunks.size() && chunks[current].size < need) {
+        stats.bytes += chunks[current].size;
+        ++current;
+    }
+    if (current == chunks.size()) {
+        const size_t chunkSize = std::max(CHUNK_SIZE, need);
+        chunks.push_back({ static_cast<uint8_t*>(::operator new(chunkSize)), chunkSize });
+        ++stats.chunks;
+        stats.reserved += chunkSize;
+        ++stats.heapAllocs;
+    }
+    offset = 0;
+    return allocate(size, align);
+}
+
+void LevelArena::reset()
+{
+    for (Dtor* d = dtors; d; d = d->next) d->destroy(d->object);
+    dtors = nullptr;
+    current = 0;
+    offset = 0;
+    stats.objects = 0;
+    stats.bytes = 0;
+    stats.heapAllocs = 0;
+}
+
+void LevelArena::release()
+{
+    reset();
+    for (Chunk& c : chunks) ::operator delete(c.data);
+    chunks.clear();
+    stats.chunks = 0;
+    stats.reserved = 0;
+}
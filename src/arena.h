@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator for the objects that live exactly as long as one level (Game uses it for
+// the map, background, in-game panel and the two characters). make() constructs in place
+// in the current chunk and remembers the destructor; reset() runs the destructors newest
+// first and rewinds, keeping the chunks, so ending a level is one call and the next one
+// reuses the same memory for those objects. Only the objects themselves live here: what
+// they own (Map's grid, a route, Panel children, textures) is still allocated as before.
+// Not thread-safe: the main thread owns it (the sim thread is stopped around loads).
+class LevelArena {
+public:
+    static const size_t CHUNK_SIZE = 64 * 1024;
+
+    struct Stats {
+        size_t objects = 0;     // constructed since the last reset
+        size_t bytes = 0;       // used since the last reset (objects + bookkeeping + padding)
+        size_t peakBytes = 0;   // highest `bytes` ever
+        size_t chunks = 0;      // chunks held (reused across resets)
+        size_t reserved = 0;    // bytes held in chunks
+        size_t heapAllocs = 0;  // chunks allocated since the last reset (0 = the objects fit in kept chunks)
+    };
+
+    LevelArena() = default;
+    ~LevelArena();
+    LevelArena(const LevelArena&) = delete;
+    LevelArena& operator=(const LevelArena&) = delete;
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args)
+    {
+        void* mem = allocate(sizeof(T), alignof(T));
+        T* obj = new (mem) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            Dtor* d = static_cast<Dtor*>(allocate(sizeof(Dtor), alignof(Dtor)));
+            d->object = obj;
+            d->destroy = [](void* p) { static_cast<T*>(p)->~T(); };
+            d->next = dtors;
+            dtors = d;
+        }
+        ++stats.objects;
+        return obj;
+    }
+
+    // raw memory, released by the next reset()
+    void* allocate(size_t size, size_t align);
+
+    // destroy every object (newest first) and rewind; chunks are kept for the next level
+    void reset();
+    // reset() and give the chunks back to the heap
+    void release();
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Dtor {
+        void* object;
+        void (*destroy)(void*);
+        Dtor* next;
+    };
+    struct Chunk {
+        uint8_t* data;
+        size_t size;
+    };
+
+    std::vector<Chunk> chunks;
+    size_t current = 0; // chunk being filled
+    size_t offset = 0;  // into chunks[current]
+    Dtor* dtors = nullptr;
+    Stats stats;
+};
@@ -0,0 +1,366 @@
+#include "assets.h"
+#include "jobs.h"
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ---------- MappedFile ----------
+
+MappedFile::~MappedFile() { close(); }
+
+bool MappedFile::open(const std::string& path, bool shareWrite)
+{
+    close();
+#ifdef _WIN32
+    const DWORD share = shareWrite ? FILE_SHARE_READ | FILE_SHARE_WRITE : FILE_SHARE_READ;
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, share, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(f, &sz) || sz.QuadPart == 0) { CloseHandle(f); return false; }
+    HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m) { CloseHandle(f); return false; }
+    void* view = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+    if (!view) { CloseHandle(m); CloseHandle(f); return false; }
+    fileHandle = f;
+    mapHandle = m;
+    bytes = static_cast<const uint8_t*>(view);
+    length = static_cast<size_t>(sz.QuadPart);
+#else
+    (void)shareWrite; // POSIX never locks a mapped file
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping stays valid
+    if (view == MAP_FAILED) return false;
+    bytes = static_cast<const uint8_t*>(view);
+    length = static_cast<size_t>(st.st_size);
+#endif
+    return true;
+}
+
+bool MappedFile::openWritable(const std::string& path, size_t size)
+{
+    close();
+#ifdef _WIN32
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER sz;
+    if (size) {
+        sz.QuadPart = static_cast<LONGLONG>(size);
+        if (!SetFilePointerEx(f, sz, nullptr, FILE_BEGIN) || !SetEndOfFile(f)) { CloseHandle(f); return false; }
+    }
+    if (!GetFileSizeEx(f, &sz) || sz.QuadPart == 0) { CloseHandle(f); return false; }
+    HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    if (!m) { CloseHandle(f); return false; }
+    void* view = MapViewOfFile(m, FILE_MAP_WRITE, 0, 0, 0);
+    if (!view) { CloseHandle(m); CloseHandle(f); return false; }
+    fileHandle = f;
+    mapHandle = m;
+    bytes = static_cast<const uint8_t*>(view);
+    length = static_cast<size_t>(sz.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+    if (size && ftruncate(fd, static_cast<off_t>(size)) != 0) { ::close(fd); return false; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+    bytes = static_cast<const uint8_t*>(view);
+    length = static_cast<size_t>(st.st_size);
+#endif
+    writable = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (!bytes) return;
+#ifdef _WIN32
+    UnmapViewOfFile(bytes);
+    CloseHandle(static_cast<HANDLE>(mapHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    mapHandle = fileHandle = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(bytes), length);
+#endif
+    bytes = nullptr;
+    length = 0;
+    writable = false;
+}
+
+// ---------- Assets ----------
+
+namespace {
+struct PackEntry {
+    uint64_t pathHash;
+    uint32_t pathOffset;
+    uint32_t pathLength;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+    uint64_t dataHash;
+};
+static_assert(sizeof(PackEntry) == 40, "pack TOC entry must be 40 bytes");
+
+MappedFile g_pack;
+const PackEntry* g_toc = nullptr;
+uint32_t g_count = 0;
+bool g_loose = false;
+
+struct Prefetched {
+    SDL_Surface* surface = nullptr;
+    JobGroup group;
+};
+std::map<std::string, std::shared_ptr<Prefetched>> g_prefetched;
+
+struct SharedTexture {
+    std::string path; // empty once forgotten: destroyed on the last release
+    int refs = 0;
+};
+std::unordered_map<SDL_Texture*, SharedTexture> g_shared;
+std::unordered_map<std::string, SDL_Texture*> g_sharedByPath;
+}
+
+bool Assets::init(const std::string& packPath)
+{
+    shutdown();
+    // dev mode (hot reload) edits loose files, so it never reads the pack either
+    const char* loose = SDL_getenv("MUMMYMAZE_LOOSE_ASSETS");
+    const char* dev = SDL_getenv("MUMMYMAZE_DEV");
+    g_loose = (loose && loose[0] && loose[0] != '0') || (dev && dev[0] && dev[0] != '0');
+    if (g_loose) {
+        std::cerr << "Assets::init - loose asset mode, using loose files\n";
+        return false;
+    }
+    if (!g_pack.open(packPath)) {
+        std::cerr << "Assets::init - no " << packPath << ", using loose files\n";
+        return false;
+    }
+
+    const uint8_t* p = g_pack.data();
+    size_t n = g_pack.size();
+    uint32_t version = 0, count = 0;
+    if (n >= 16) {
+        std::memcpy(&version, p + 4, 4);
+        std::memcpy(&count, p + 8, 4);
+    }
+    if (n < 16 || std::memcmp(p, "MMPK", 4) != 0 || version != PACK_VERSION ||
+        16 + static_cast<uint64_t>(count) * sizeof(PackEntry) > n) {
+        std::cerr << "Assets::init - " << packPath << " is not a valid pack, using loose files\n";
+        g_pack.close();
+        return false;
+    }
+    const PackEntry* toc = reinterpret_cast<const PackEntry*>(p + 16);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (toc[i].pathOffset + static_cast<uint64_t>(toc[i].pathLength) > n ||
+            toc[i].dataOffset + toc[i].dataSize > n) {
+            std::cerr << "Assets::init - " << packPath << " entry " << i << " out of range, using loose files\n";
+            g_pack.close();
+            return false;
+        }
+    }
+    g_toc = toc;
+    g_count = count;
+    std::cerr << "Assets::init - mapped " << packPath << " (" << count << " entries, " << n << " bytes)\n";
+    return true;
+}
+
+void Assets::shutdown()
+{
+    g_pack.close();
+    g_toc = nullptr;
+    g_count = 0;
+}
+
+bool Assets::hasPack() { return g_toc != nullptr; }
+
+uint64_t Assets::hashPath(const std::string& path)
+{
+    uint64_t h = 1469598103934665603ull;
+    for (char c : path) {
+        h ^= static_cast<uint8_t>(c == '\\' ? '/' : c);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+bool Assets::find(const std::string& path, const void*& data, size_t& size, uint64_t* dataHash)
+{
+    if (!g_toc) return false;
+    const uint64_t h = hashPath(path);
+    uint32_t lo = 0, hi = g_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (g_toc[mid].pathHash < h) lo = mid + 1;
+        else hi = mid;
+    }
+    for (uint32_t i = lo; i < g_count && g_toc[i].pathHash == h; ++i) {
+        const PackEntry& e = g_toc[i];
+        if (e.pathLength == path.size() &&
+            std::memcmp(g_pack.data() + e.pathOffset, path.data(), path.size()) == 0) {
+            data = g_pack.data() + e.dataOffset;
+            size = static_cast<size_t>(e.dataSize);
+            if (dataHash) *dataHash = e.dataHash;
+            return true;
+        }
+    }
+    return false;
+}
+
+SDL_IOStream* Assets::open(const std::string& path)
+{
+    const void* data = nullptr;
+    size_t size = 0;
+    if (find(path, data, size)) return SDL_IOFromConstMem(data, size);
+    return SDL_IOFromFile(path.c_str(), "rb");
+}
+
+SDL_Texture* Assets::loadTexture(SDL_Renderer* renderer, const std::string& path)
+{
+    auto it = g_prefetched.find(path);
+    if (it != g_prefetched.end()) {
+        it->second->group.wait();
+        if (it->second->surface) return SDL_CreateTextureFromSurface(renderer, it->second->surface);
+    }
+    SDL_IOStream* io = open(path);
+    return io ? IMG_LoadTexture_IO(renderer, io, true) : nullptr;
+}
+
+SDL_Surface* Assets::loadSurface(const std::string& path)
+{
+    SDL_IOStream* io = open(path);
+    return io ? IMG_Load_IO(io, true) : nullptr;
+}
+
+TTF_Font* Assets::openFont(const std::string& path, float ptsize)
+{
+    SDL_IOStream* io = open(path);
+    return io ? TTF_OpenFontIO(io, true, ptsize) : nullptr;
+}
+
+bool Assets::loadWAV(const std::string& path, SDL_AudioSpec* spec, Uint8** buf, Uint32* len)
+{
+    SDL_IOStream* io = open(path);
+    return io && SDL_LoadWAV_IO(io, true, spec, buf, len);
+}
+
+bool Assets::loadText(const std::string& path, std::string& out)
+{
+    const void* data = nullptr;
+    size_t size = 0;
+    if (find(path, data, size)) {
+        out.assign(static_cast<const char*>(data), size);
+        return true;
+    }
+    size_t n = 0;
+    void* loaded = SDL_LoadFile(path.c_str(), &n);
+    if (!loaded) return false;
+    out.assign(static_cast<const char*>(loaded), n);
+    SDL_free(loaded);
+    return true;
+}
+
+void Assets::prefetch(const std::vector<std::string>& paths)
+{
+    for (const std::string& path : paths) {
+        if (g_prefetched.count(path)) continue;
+        auto entry = std::make_shared<Prefetched>();
+        g_prefetched[path] = entry;
+        JobPool::instance().submit([entry, path]() {
+            entry->surface = loadSurface(path);
+        }, &entry->group);
+    }
+}
+
+void Assets::dropPrefetched()
+{
+    for (auto& kv : g_prefetched) {
+        kv.second->group.wait();
+        if (kv.second->surface) SDL_DestroySurface(kv.second->surface);
+    }
+    g_prefetched.clear();
+}
+
+SDL_Texture* Assets::acquireTexture(SDL_Renderer* renderer, const std::string& path)
+{
+    auto it = g_sharedByPath.find(path);
+    if (it != g_sharedByPath.end()) {
+        ++g_shared[it->second].refs;
+        return it->second;
+    }
+    SDL_Texture* tex = loadTexture(renderer, path);
+    if (!tex) return nullptr;
+    SharedTexture& entry = g_shared[tex];
+    entry.path = path;
+    entry.refs = 1;
+    g_sharedByPath[path] = tex;
+    return tex;
+}
+
+void Assets::releaseTexture(SDL_Texture* tex)
+{
+    if (!tex) return;
+    auto it = g_shared.find(tex);
+    if (it == g_shared.end()) {
+        SDL_DestroyTexture(tex);
+        return;
+    }
+    if (--it->second.refs > 0) return;
+    it->second.refs = 0;
+    if (it->second.path.empty()) { // đã bị forget: không ai lấy lại được nữa
+        SDL_DestroyTexture(tex);
+        g_shared.erase(it);
+    }
+}
+
+void Assets::forgetTexture(const std::string& path)
+{
+    auto it = g_sharedByPath.find(path);
+    if (it == g_sharedByPath.end()) return;
+    SDL_Texture* tex = it->second;
+    g_sharedByPath.erase(it);
+    auto entry = g_shared.find(tex);
+    if (entry == g_shared.end()) return;
+    if (entry->second.refs > 0) {
+        entry->second.path.clear();
+    } else {
+        SDL_DestroyTexture(tex);
+        g_shared.erase(entry);
+    }
+}
+
+void Assets::trimTextures()
+{
+    int freed = 0;
+    for (auto it = g_shared.begin(); it != g_shared.end();) {
+        if (it->second.refs > 0) { ++it; continue; }
+        g_sharedByPath.erase(it->second.path);
+        SDL_DestroyTexture(it->first);
+        it = g_shared.erase(it);
+        ++freed;
+    }
+    if (freed) std::cerr << "Assets::trimTextures - freed " << freed << " textures, " << g_shared.size() << " still held\n";
+}
+
+void Assets::clearTextures()
+{
+    for (auto& kv : g_shared) SDL_DestroyTexture(kv.first);
+    g_shared.clear();
+    g_sharedByPath.clear();
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Whole file mapped read-only into memory (mmap / MapViewOfFile), or read-write and
+// shared with the file (openWritable) for small on-disk structures such as users.idx.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // read-only view; shareWrite lets the file be appended to while it is mapped (the view
+    // keeps the size it had: open again to see new bytes; it must be closed before the file
+    // is replaced, Windows refuses to rename over a mapped file)
+    bool open(const std::string& path, bool shareWrite = false);
+    // create the file if needed, resize it to `size` bytes (0 = keep, must not be empty) and
+    // map it read-write; stores through writableData() go to the file
+    bool openWritable(const std::string& path, size_t size = 0);
+    void close();
+
+    const uint8_t* data() const { return bytes; }
+    uint8_t* writableData() const { return writable ? const_cast<uint8_t*>(bytes) : nullptr; }
+    size_t size() const { return length; }
+    bool isOpen() const { return bytes != nullptr; }
+
+private:
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+    bool writable = false;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mapHandle = nullptr;
+#endif
+};
+
+// Asset access for the whole game.
+// When assets.pak (built by tools/pack_assets.cpp) is present it is mapped once and
+// every asset is served from memory through SDL_IOFromConstMem; anything missing from
+// the pack, or everything when MUMMYMAZE_LOOSE_ASSETS or MUMMYMAZE_DEV is set, is read
+// from the loose file.
+//
+// Pack layout (little endian):
+//   header  : "MMPK", u32 version, u32 entryCount, u32 reserved
+//   toc     : entryCount x { u64 pathHash, u32 pathOffset, u32 pathLength, u64 dataOffset, u64 dataSize,
+//             u64 dataHash }
+//             sorted by pathHash (FNV-1a of the '/'-separated path, e.g. "assets/font.ttf");
+//             dataHash identifies the content (FNV-1a over 8-byte words, see pack_assets)
+//   strings : path bytes referenced by pathOffset
+//   data    : each entry aligned to PACK_ALIGN bytes
+class Assets {
+public:
+    static const uint32_t PACK_VERSION = 2; // 2: dataHash in the toc
+    static const uint32_t PACK_ALIGN = 64;
+
+    // map the pack; false (and loose files only) when it is missing or invalid
+    static bool init(const std::string& packPath = "assets.pak");
+    static void shutdown();
+    static bool hasPack();
+
+    static uint64_t hashPath(const std::string& path);
+
+    // raw bytes of a packed asset and the content hash stored by the packer; false if it is
+    // not in the pack
+    static bool find(const std::string& path, const void*& data, size_t& size, uint64_t* dataHash = nullptr);
+
+    // stream over the asset (pack first, loose file fallback); caller closes it
+    static SDL_IOStream* open(const std::string& path);
+
+    // helpers mirroring the SDL loaders the game used with plain paths
+    static SDL_Texture* loadTexture(SDL_Renderer* renderer, const std::string& path);
+    static SDL_Surface* loadSurface(const std::string& path);
+    static TTF_Font* openFont(const std::string& path, float ptsize);
+    static bool loadWAV(const std::string& path, SDL_AudioSpec* spec, Uint8** buf, Uint32* len);
+    static bool loadText(const std::string& path, std::string& out);
+
+    // decode these images in parallel on the JobPool; loadTexture() then only does the
+    // texture upload. Surfaces stay cached (shared by repeated loads of the same path,
+    // e.g. button skins) until dropPrefetched(). Main thread only.
+    static void prefetch(const std::vector<std::string>& paths);
+    static void dropPrefetched();
+
+    // Shared textures for the one long-lived renderer: acquiring a path that is already
+    // loaded returns the same texture and bumps its reference count. Textures nobody holds
+    // any more stay cached until trimTextures() (the SceneManager trims after a scene is
+    // popped), so restarting a level or reopening a panel uploads nothing again.
+    // Shared textures must not get per-user state (alpha/colour mod). Main thread only.
+    static SDL_Texture* acquireTexture(SDL_Renderer* renderer, const std::string& path);
+    // drop one reference; a texture that did not come from acquireTexture is destroyed
+    static void releaseTexture(SDL_Texture* tex);
+    // the file changed on disk (dev mode): the next acquire loads it again, holders of
+    // the old texture keep it until they release it
+    static void forgetTexture(const std::string& path);
+    static void trimTextures();
+    // destroy everything; only right before the renderer goes away
+    static void clearTextures();
+};
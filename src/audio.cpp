@@ -1,8 +1,18 @@
 #include "audio.h"
+#include "assets.h"
 #include <iostream>
 #include <cstring>
-#include <thread>
-#include <chrono>
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define AUDIO_SSE 1
+#endif
+
+namespace {
+const char* const SFX_PATHS[static_cast<int>(Sfx::Count)] = {
+    "assets/audio/victory.wav",
+    "assets/audio/lost.wav",
+};
+}
 
 Audio::Audio() {}
 
@@ -11,87 +21,179 @@ Audio::~Audio() {
 }
 
 bool Audio::init() {
-    // SDL audio được init tự động khi mở device
-    return true;
+    ready = initSubsystem() && openDevice();
+    return ready;
+}
+
+void Audio::initAsync(int fadeMs) {
+    if (ready || initStarted) return;
+    initStartNs = SDL_GetTicksNS();
+    if (!initSubsystem()) return; // no sound; the game goes on
+    initStarted = true;
+    fadeInMs = fadeMs;
+    initDone.store(false, std::memory_order_relaxed);
+    initThread = std::thread([this]() {
+        initOk = openDevice();
+        initDone.store(true, std::memory_order_release);
+    });
+}
+
+void Audio::joinInit() {
+    if (initThread.joinable()) initThread.join();
+}
+
+void Audio::poll() {
+    if (!initStarted || !initDone.load(std::memory_order_acquire)) return;
+    joinInit();
+    initStarted = false;
+    const double ms = (SDL_GetTicksNS() - initStartNs) / 1e6;
+    if (!initOk) {
+        std::cerr << "Audio::poll - background init failed after " << ms << " ms, no sound\n";
+        return;
+    }
+    ready = true;
+    std::cerr << "Audio::poll - audio ready " << ms << " ms after init started\n";
+    if (!musicEnabled) setMusicEnabled(false);
+    if (!pendingMusic.empty()) {
+        const std::string path = pendingMusic;
+        pendingMusic.clear();
+        playMusic(path, fadeInMs); // fade-in: chưa có bài nào để crossfade
+    }
 }
 
-bool Audio::loadBackgroundMusic(const std::string& filepath) {
-    cleanup(); // Cleanup trước nếu có
-    
-    // Load WAV file
-    if (!SDL_LoadWAV(filepath.c_str(), &audioSpec, &audioBuffer, &audioLength)) {
-        std::cerr << "Audio::loadBackgroundMusic - Failed to load " << filepath 
-                  << ": " << SDL_GetError() << "\n";
+bool Audio::initSubsystem() {
+    if (subsystemStarted) return true;
+    if (!SDL_InitSubSystem(SDL_INIT_AUDIO)) {
+        std::cerr << "Audio::init - SDL_InitSubSystem(AUDIO) failed: " << SDL_GetError() << "\n";
         return false;
     }
-    
-    // Tạo audio stream với format từ WAV file
-    audioStream = SDL_OpenAudioDeviceStream(
-        SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK,
-        &audioSpec,
-        audioCallback,
-        this
-    );
-    
+    subsystemStarted = true;
+    return true;
+}
+
+bool Audio::openDevice() {
+    releaseDevice();
+
+    // mix ở dạng float với rate/số kênh của device, để SDL không phải resample lần nữa
+    SDL_AudioSpec deviceSpec{};
+    int deviceFrames = 0;
+    mixSpec.format = SDL_AUDIO_F32;
+    mixSpec.freq = 48000;
+    mixSpec.channels = 2;
+    if (SDL_GetAudioDeviceFormat(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &deviceSpec, &deviceFrames)) {
+        if (deviceSpec.freq > 0) mixSpec.freq = deviceSpec.freq;
+        if (deviceSpec.channels == 1) mixSpec.channels = 1;
+    }
+    mixBuffer.assign(static_cast<size_t>(MIX_CHUNK_FRAMES) * mixSpec.channels, 0.0f);
+
+    for (int i = 0; i < static_cast<int>(Sfx::Count); ++i) {
+        if (!loadSound(SFX_PATHS[i], bank[i]))
+            std::cerr << "Audio::init - failed to load " << SFX_PATHS[i] << ": " << SDL_GetError() << "\n";
+    }
+
+    audioStream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &mixSpec, audioCallback, this);
     if (!audioStream) {
-        std::cerr << "Audio::loadBackgroundMusic - Failed to open audio stream: " 
-                  << SDL_GetError() << "\n";
-        SDL_free(audioBuffer);
-        audioBuffer = nullptr;
+        std::cerr << "Audio::init - Failed to open audio stream: " << SDL_GetError() << "\n";
         return false;
     }
-    
-    audioPosition = 0;
-    isPlaying = false;
-    
-    std::cout << "Audio::loadBackgroundMusic - Loaded " << filepath 
-              << " (length: " << audioLength << " bytes)\n";
+    // SDL_OpenAudioDeviceStream tạo device ở trạng thái paused
+    SDL_ResumeAudioDevice(SDL_GetAudioStreamDevice(audioStream));
+    musicThreadRunning = true;
+    musicThread = std::thread([this]() { musicThreadMain(); });
+    std::cerr << "Audio::init - mixer " << mixSpec.freq << " Hz, " << mixSpec.channels << " ch, "
+              << MAX_VOICES << " voices (device period " << deviceFrames << " frames)\n";
     return true;
 }
 
-void Audio::playBackgroundMusic(bool loop) {
-    if (!audioStream || !audioBuffer) {
-        std::cerr << "Audio::playBackgroundMusic - No music loaded\n";
-        return;
+bool Audio::loadSound(const std::string& path, Sound& out) {
+    SDL_AudioSpec spec;
+    Uint8* buf = nullptr;
+    Uint32 len = 0;
+    if (!Assets::loadWAV(path, &spec, &buf, &len)) return false;
+
+    Uint8* converted = nullptr;
+    int convertedLen = 0;
+    const bool ok = SDL_ConvertAudioSamples(&spec, buf, static_cast<int>(len), &mixSpec, &converted, &convertedLen);
+    SDL_free(buf);
+    if (!ok) return false;
+
+    out.path = path;
+    out.samples.assign(reinterpret_cast<const float*>(converted),
+                       reinterpret_cast<const float*>(converted) + convertedLen / sizeof(float));
+    out.frames = static_cast<Uint32>(out.samples.size() / mixSpec.channels);
+    SDL_free(converted);
+    return true;
+}
+
+bool Audio::playMusic(const std::string& filepath, int fadeMs, bool loop) {
+    if (!ready) {
+        pendingMusic = filepath; // phát khi init xong
+        return true;
     }
-    
-    shouldLoop = loop;
-    audioPosition = 0;
-    
-    // Pre-feed một lượng data ban đầu vào stream để tránh underrun
-    // Tính toán dựa trên sample rate: ~1 giây audio
-    int bytesPerSecond = audioSpec.freq * audioSpec.channels * (SDL_AUDIO_BITSIZE(audioSpec.format) / 8);
-    int preBufferSize = bytesPerSecond; // Buffer 1 giây
-    
-    if (preBufferSize > static_cast<int>(audioLength)) {
-        preBufferSize = static_cast<int>(audioLength);
-    }
-    
-    if (preBufferSize > 0 && musicEnabled) {
-        SDL_PutAudioStreamData(audioStream, audioBuffer, preBufferSize);
-        audioPosition = preBufferSize;
-    }
-    
-    // Resume audio device (SDL_OpenAudioDeviceStream tạo device ở trạng thái paused)
-    SDL_ResumeAudioDevice(SDL_GetAudioStreamDevice(audioStream));
-    SDL_SetAudioStreamGain(audioStream, 0.2f);
-    isPlaying = true;
+    if (!audioStream) return false;
+    if (filepath == musicPath) return true;
+
+    auto stream = std::make_unique<MusicStream>();
+    if (!stream->open(filepath, mixSpec, loop)) {
+        std::cerr << "Audio::playMusic - Failed to load " << filepath << "\n";
+        return false;
+    }
+    MusicStream* raw = stream.get();
+    const size_t resident = raw->residentBytes();
+    {
+        std::lock_guard<std::mutex> lock(musicMutex);
+        streams.push_back(std::move(stream));
+    }
+    musicWake.notify_one();
+
+    Command cmd;
+    cmd.kind = Command::Kind::MusicStart;
+    cmd.stream = raw;
+    cmd.fadeFrames = static_cast<Uint32>(static_cast<Sint64>(fadeMs > 0 ? fadeMs : 0) * mixSpec.freq / 1000);
+    if (!pushCommand(cmd)) {
+        raw->released.store(true, std::memory_order_release);
+        return false;
+    }
+    musicPath = filepath;
+    std::cout << "Audio::playMusic - streaming " << filepath << " (" << resident / 1024 << " KB resident)\n";
+    return true;
+}
+
+bool Audio::pushCommand(const Command& cmd) {
+    if (!ready || !audioStream) return false;
+    if (!commands.push(cmd)) {
+        std::cerr << "Audio - command queue full, dropped\n";
+        return false;
+    }
+    return true;
+}
+
+bool Audio::play(Sfx sfx, float gain) {
+    // bank[] is filled by initThread: not touched here before poll() has seen initDone
+    if (!ready) return false;
+    const int id = static_cast<int>(sfx);
+    if (id < 0 || id >= static_cast<int>(Sfx::Count) || bank[id].frames == 0) return false;
+    Command cmd;
+    cmd.kind = Command::Kind::Play;
+    cmd.sound = id;
+    cmd.gain = gain;
+    return pushCommand(cmd);
+}
+
+bool Audio::playOneShot(const std::string& filepath) {
+    if (!ready) return false; // bank[] may still be loading on initThread
+    for (int i = 0; i < static_cast<int>(Sfx::Count); ++i)
+        if (bank[i].path == filepath) return play(static_cast<Sfx>(i));
+    std::cerr << "Audio::playOneShot - " << filepath << " is not in the sound bank\n";
+    return false;
 }
 
 void Audio::setMusicEnabled(bool enabled) {
     musicEnabled = enabled;
-    
-    if (!audioStream) return;
-    
-    if (enabled) {
-        // Bật nhạc: Resume và set gain = 1.0
-        SDL_ResumeAudioDevice(SDL_GetAudioStreamDevice(audioStream));
-        SDL_SetAudioStreamGain(audioStream, 0.2f);
-        isPlaying = true;
-    } else {
-        // Tắt nhạc: Set gain = 0 (không pause để giữ vị trí)
-        SDL_SetAudioStreamGain(audioStream, 0.0f);
-    }
+    Command cmd;
+    cmd.kind = Command::Kind::MusicPause;
+    cmd.pause = !enabled;
+    pushCommand(cmd);
 }
 
 bool Audio::isMusicEnabled() const {
@@ -99,129 +201,196 @@ bool Audio::isMusicEnabled() const {
 }
 
 void Audio::cleanup() {
+    joinInit(); // openDevice() có thể còn đang chạy trên initThread
+    initStarted = false;
+    ready = false;
+    musicPath.clear();
+    pendingMusic.clear();
+    releaseDevice();
+    if (subsystemStarted) {
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        subsystemStarted = false;
+    }
+}
+
+void Audio::releaseDevice() {
     if (audioStream) {
-        SDL_DestroyAudioStream(audioStream);
+        SDL_DestroyAudioStream(audioStream); // dừng callback trước khi giải phóng dữ liệu
         audioStream = nullptr;
     }
-    
-    if (audioBuffer) {
-        SDL_free(audioBuffer);
-        audioBuffer = nullptr;
+    stopMusicThread();
+    streams.clear();
+    musicCurrent = musicFading = nullptr;
+    fadeTotal = fadePos = 0;
+    for (Voice& v : voices) v = Voice{};
+    for (Sound& s : bank) s = Sound{};
+    commands.clear();
+}
+
+void Audio::stopMusicThread() {
+    {
+        std::lock_guard<std::mutex> lock(musicMutex);
+        musicThreadRunning = false;
+    }
+    musicWake.notify_one();
+    if (musicThread.joinable()) musicThread.join();
+}
+
+void Audio::musicThreadMain() {
+    std::unique_lock<std::mutex> lock(musicMutex);
+    while (musicThreadRunning) {
+        bool worked = false;
+        for (auto it = streams.begin(); it != streams.end();) {
+            if ((*it)->released.load(std::memory_order_acquire)) {
+                it = streams.erase(it); // callback không còn đọc nó nữa
+                continue;
+            }
+            worked = (*it)->fill() || worked;
+            ++it;
+        }
+        // ring 8192 frame ~170 ms ở 48 kHz: thức dậy mỗi 20 ms là dư
+        musicWake.wait_for(lock, std::chrono::milliseconds(worked ? 5 : 20));
     }
-    
-    audioLength = 0;
-    audioPosition = 0;
-    isPlaying = false;
 }
 
 // Static callback function
 void Audio::audioCallback(void* userdata, SDL_AudioStream* stream, int additional_amount, int total_amount) {
     Audio* audio = static_cast<Audio*>(userdata);
-    if (audio) {
-        audio->feedAudioData(additional_amount);
-    }
-}
-
-void Audio::feedAudioData(int neededBytes) {
-    if (!audioStream || !audioBuffer || !musicEnabled) return;
-    
-    // Chỉ feed đủ data mà stream cần, không feed quá nhiều
-    // Giữ buffer ở mức ~0.5-1 giây để tránh rè
-    const int maxBufferBytes = 65536; // ~64KB buffer tối đa
-    
-    // Kiểm tra xem stream đã có đủ data chưa
-    int queued = SDL_GetAudioStreamQueued(audioStream);
-    if (queued >= maxBufferBytes) {
-        // Đã có đủ buffer, không cần feed thêm
-        return;
+    if (!audio || additional_amount <= 0) return;
+    const int frameBytes = static_cast<int>(sizeof(float)) * audio->mixSpec.channels;
+    int frames = (additional_amount + frameBytes - 1) / frameBytes;
+    audio->applyCommands();
+    while (frames > 0) {
+        const int n = frames < MIX_CHUNK_FRAMES ? frames : MIX_CHUNK_FRAMES;
+        audio->mix(n);
+        SDL_PutAudioStreamData(stream, audio->mixBuffer.data(), n * frameBytes);
+        frames -= n;
     }
-    
-    // Tính số bytes cần feed (đủ để đạt maxBufferBytes hoặc theo yêu cầu)
-    int bytesToFeed = maxBufferBytes - queued;
-    if (neededBytes > 0 && neededBytes < bytesToFeed) {
-        bytesToFeed = neededBytes;
-    }
-    
-    // Tính số bytes còn lại trong buffer
-    int bytesRemaining = static_cast<int>(audioLength - audioPosition);
-    
-    if (bytesRemaining <= 0) {
-        // Đã hết data
-        if (shouldLoop) {
-            // Loop: reset về đầu
-            audioPosition = 0;
-            bytesRemaining = static_cast<int>(audioLength);
-        } else {
-            // Không loop: dừng
-            return;
+}
+
+void Audio::applyCommands() {
+    Command cmd;
+    while (commands.pop(cmd)) {
+        if (cmd.kind == Command::Kind::MusicPause) {
+            musicPaused = cmd.pause;
+            continue;
         }
-    }
-    
-    // Giới hạn số bytes feed dựa trên data còn lại
-    if (bytesToFeed > bytesRemaining) {
-        bytesToFeed = bytesRemaining;
-    }
-    
-    if (bytesToFeed > 0) {
-        const Uint8* dataToFeed = audioBuffer + audioPosition;
-        int result = SDL_PutAudioStreamData(audioStream, dataToFeed, bytesToFeed);
-        if (result < 0) {
-            std::cerr << "Audio::feedAudioData - Failed to put audio data: " 
-                      << SDL_GetError() << "\n";
-            return;
+        if (cmd.kind == Command::Kind::MusicStart) {
+            // bài đang fade-out dở bị cắt, bài hiện tại chuyển sang fade-out
+            if (musicFading) musicFading->released.store(true, std::memory_order_release);
+            musicFading = musicCurrent;
+            musicCurrent = cmd.stream;
+            fadeTotal = cmd.fadeFrames;
+            fadePos = 0;
+            if (fadeTotal == 0 && musicFading) {
+                musicFading->released.store(true, std::memory_order_release);
+                musicFading = nullptr;
+            }
+            continue;
         }
-        
-        audioPosition += bytesToFeed;
-        
-        // Nếu đã hết và cần loop, reset
-        if (audioPosition >= audioLength && shouldLoop) {
-            audioPosition = 0;
+        // voice rảnh đầu tiên, nếu hết thì lấy voice cũ nhất
+        Voice* slot = &voices[0];
+        for (Voice& v : voices) {
+            if (!v.sound) { slot = &v; break; }
+            if (v.started < slot->started) slot = &v;
         }
+        slot->sound = &bank[cmd.sound];
+        slot->pos = 0;
+        slot->gain = cmd.gain;
+        slot->started = ++voiceCounter;
     }
 }
 
-bool Audio::playOneShot(const std::string& filepath) {
-    SDL_AudioSpec spec;
-    Uint8* buf = nullptr;
-    Uint32 len = 0;
-    if (!SDL_LoadWAV(filepath.c_str(), &spec, &buf, &len)) {
-        std::cerr << "Audio::playOneShot - Failed to load " << filepath
-                  << ": " << SDL_GetError() << "\n";
-        return false;
-    }
+void Audio::mix(int frames) {
+    const int ch = mixSpec.channels;
+    float* out = mixBuffer.data();
+    std::memset(out, 0, sizeof(float) * frames * ch);
 
-    SDL_AudioStream* stream = SDL_OpenAudioDeviceStream(
-        SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK,
-        &spec,
-        nullptr,
-        nullptr
-    );
+    for (Voice& v : voices) {
+        if (!v.sound) continue;
+        const Uint32 left = v.sound->frames - v.pos;
+        const int n = left < static_cast<Uint32>(frames) ? static_cast<int>(left) : frames;
+        mixAdd(out, v.sound->samples.data() + static_cast<size_t>(v.pos) * ch, n * ch, v.gain);
+        v.pos += n;
+        if (v.pos >= v.sound->frames) v.sound = nullptr;
+    }
 
-    if (!stream) {
-        std::cerr << "Audio::playOneShot - Failed to open audio stream: "
-                  << SDL_GetError() << "\n";
-        SDL_free(buf);
-        return false;
+    // tạm dừng: không đọc ring, vị trí giữ nguyên và music thread tự ngừng giải mã khi ring đầy
+    if (!musicPaused && (musicCurrent || musicFading)) {
+        float in0 = 1.0f, in1 = 1.0f;
+        if (fadeTotal > 0) {
+            in0 = fadePos >= fadeTotal ? 1.0f : static_cast<float>(fadePos) / fadeTotal;
+            const Uint32 end = fadePos + static_cast<Uint32>(frames);
+            in1 = end >= fadeTotal ? 1.0f : static_cast<float>(end) / fadeTotal;
+            fadePos = end < fadeTotal ? end : fadeTotal;
+        }
+        if (musicCurrent) {
+            mixMusic(musicCurrent, out, frames, MUSIC_VOLUME * in0, MUSIC_VOLUME * in1);
+            if (musicCurrent->finished()) {
+                musicCurrent->released.store(true, std::memory_order_release);
+                musicCurrent = nullptr;
+            }
+        }
+        if (musicFading) {
+            mixMusic(musicFading, out, frames, MUSIC_VOLUME * (1.0f - in0), MUSIC_VOLUME * (1.0f - in1));
+            if (fadePos >= fadeTotal || musicFading->finished()) {
+                musicFading->released.store(true, std::memory_order_release);
+                musicFading = nullptr;
+            }
+        }
     }
 
-    int result = SDL_PutAudioStreamData(stream, buf, static_cast<int>(len));
-    if (result < 0) {
-        std::cerr << "Audio::playOneShot - Failed to put audio data: " << SDL_GetError() << "\n";
-        SDL_DestroyAudioStream(stream);
-        SDL_free(buf);
-        return false;
+    clampBuffer(out, frames * ch);
+}
+
+void Audio::mixAdd(float* dst, const float* src, int count, float gain) {
+    int i = 0;
+#ifdef AUDIO_SSE
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 8 <= count; i += 8) {
+        __m128 a0 = _mm_loadu_ps(dst + i);
+        __m128 a1 = _mm_loadu_ps(dst + i + 4);
+        a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(src + i + 4), g));
+        _mm_storeu_ps(dst + i, a0);
+        _mm_storeu_ps(dst + i + 4, a1);
     }
+#endif
+    for (; i < count; ++i) dst[i] += src[i] * gain;
+}
 
-    SDL_ResumeAudioDevice(SDL_GetAudioStreamDevice(stream));
+void Audio::mixMusic(MusicStream* s, float* out, int frames, float g0, float g1) {
+    const float* a = nullptr;
+    const float* b = nullptr;
+    int na = 0, nb = 0;
+    const int n = s->readable(frames, a, na, b, nb); // thiếu dữ liệu thì phần còn lại im lặng
+    if (n == 0) return;
+    const int ch = mixSpec.channels;
+    const float gMid = g0 + (g1 - g0) * (static_cast<float>(na) / frames);
+    mixRamp(out, a, na, ch, g0, gMid);
+    if (nb > 0) mixRamp(out + static_cast<size_t>(na) * ch, b, nb, ch, gMid, g0 + (g1 - g0) * (static_cast<float>(n) / frames));
+    s->consume(n);
+}
 
-    // detached thread will wait until queued data is played and then clean up
-    std::thread([stream, buf]() {
-        while (SDL_GetAudioStreamQueued(stream) > 0) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        }
-        SDL_DestroyAudioStream(stream);
-        SDL_free(buf);
-    }).detach();
+void Audio::mixRamp(float* dst, const float* src, int frames, int channels, float g0, float g1) {
+    if (frames <= 0) return;
+    if (g0 == g1) {
+        mixAdd(dst, src, frames * channels, g0);
+        return;
+    }
+    const float step = (g1 - g0) / frames;
+    float g = g0;
+    for (int f = 0; f < frames; ++f, g += step)
+        for (int c = 0; c < channels; ++c) dst[f * channels + c] += src[f * channels + c] * g;
+}
 
-    return true;
-}
\ No newline at end of file
+void Audio::clampBuffer(float* buf, int count) {
+    int i = 0;
+#ifdef AUDIO_SSE
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(buf + i, _mm_max_ps(lo, _mm_min_ps(hi, _mm_loadu_ps(buf + i))));
+#endif
+    for (; i < count; ++i) buf[i] = buf[i] < -1.0f ? -1.0f : (buf[i] > 1.0f ? 1.0f : buf[i]);
+}
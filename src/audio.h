@@ -1,42 +1,143 @@
 #pragma once
 #include <SDL3/SDL.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+#include "simsync.h"
+#include "music.h"
 
+// Hiệu ứng âm thanh biết trước, được init() nạp sẵn vào bank
+enum class Sfx { Victory, Lost, Count };
+
+// One device stream for the whole game, mixed by us.
+// Effects are decoded once by init() and converted to the mix format (float, device
+// rate and channel count), so playing one is only a command on a lock-free queue:
+// no file access, no allocation, no thread, no extra device. The audio callback drains
+// the queue, starts the effect on a free voice of a fixed pool (the oldest voice is
+// reused when all are busy) and mixes voices + music with a vectorized loop.
+//
+// Music is streamed (see MusicStream): a music thread keeps a small ring per track
+// filled, the callback reads from it. playMusic() crossfades from the current track,
+// muting pauses the track where it is instead of playing it at gain 0.
 class Audio {
 public:
+    static const int MAX_VOICES = 16;
+    static const int MIX_CHUNK_FRAMES = 1024; // frames mixed per pass of the callback
+    static constexpr float MUSIC_VOLUME = 0.2f;
+    static constexpr const char* DEFAULT_MUSIC = "assets/audio/background_music.wav";
+
     Audio();
     ~Audio();
-    
-    // Khởi tạo hệ thống audio
+
+    // Khởi tạo hệ thống audio: mở device stream duy nhất và nạp bank hiệu ứng
     bool init();
-    
-    // Load và phát nhạc nền
-    // Lưu ý: SDL3 chỉ hỗ trợ WAV trực tiếp, MP3 cần decoder hoặc convert sang WAV
-    bool loadBackgroundMusic(const std::string& filepath);
-    void playBackgroundMusic(bool loop = true);
 
-    // Play a one-shot WAV effect (non-looping). Returns true on success.
+    // SDL's audio subsystem is started here, on the main thread (SDL requires it); the
+    // device open and the decoding of the effect bank run on a thread of their own, so the
+    // window does not wait for them. Not the JobPool: the device open can block for a long
+    // time and would hold a worker that asset decoding needs. Until poll() picks the result up the
+    // object is "not ready": playMusic()/setMusicEnabled() are remembered, effects are skipped.
+    void initAsync(int fadeInMs = 2000);
+    // main thread, once per frame: takes over a finished initAsync() and starts the
+    // remembered music with a fade-in
+    void poll();
+    bool isReady() const { return ready; }
+
+    // Phát nhạc nền (WAV 16-bit PCM hoặc IMA-ADPCM), crossfade từ bài đang phát trong
+    // fadeMs; gọi lại với bài đang phát thì không làm gì
+    bool playMusic(const std::string& filepath, int fadeMs = 0, bool loop = true);
+
+    // start a preloaded effect; safe from the game thread, returns false if not loaded
+    bool play(Sfx sfx, float gain = 1.0f);
+    // compatibility: the bank effect loaded from `filepath` (no disk access)
     bool playOneShot(const std::string& filepath);
-    
-    // Bật/tắt nhạc nền (không stop, chỉ set volume)
+
+    // Bật/tắt nhạc nền (tạm dừng thật, giữ nguyên vị trí)
     void setMusicEnabled(bool enabled);
     bool isMusicEnabled() const;
-    
+
     // Cleanup
     void cleanup();
 
 private:
+    struct Sound {
+        std::string path;
+        std::vector<float> samples; // interleaved, mix format
+        Uint32 frames = 0;
+    };
+    struct Voice {
+        const Sound* sound = nullptr; // null = free
+        Uint32 pos = 0;               // next frame
+        float gain = 1.0f;
+        Uint64 started = 0;           // for stealing the oldest voice
+    };
+    struct Command {
+        enum class Kind { Play, MusicStart, MusicPause } kind = Kind::Play;
+        int sound = 0;
+        float gain = 1.0f;
+        MusicStream* stream = nullptr; // MusicStart
+        Uint32 fadeFrames = 0;         // MusicStart
+        bool pause = false;            // MusicPause
+    };
+
     SDL_AudioStream* audioStream = nullptr;
-    SDL_AudioDeviceID audioDevice = 0;
-    Uint8* audioBuffer = nullptr;
-    Uint32 audioLength = 0;
-    Uint32 audioPosition = 0;
-    SDL_AudioSpec audioSpec;
+    SDL_AudioSpec mixSpec{};   // SDL_AUDIO_F32, device rate / channels
+    Sound bank[static_cast<int>(Sfx::Count)];
+    Voice voices[MAX_VOICES];
+    Uint64 voiceCounter = 0;
+    SpscQueue<Command, 64> commands; // game thread -> audio callback
+    std::vector<float> mixBuffer;    // MIX_CHUNK_FRAMES * channels, allocated in init()
+
+    // music, audio callback side: the track fading in (or playing) and the one fading out
+    MusicStream* musicCurrent = nullptr;
+    MusicStream* musicFading = nullptr;
+    Uint32 fadeTotal = 0;
+    Uint32 fadePos = 0;
+    bool musicPaused = false;
+
+    // music, game thread side
+    std::string musicPath; // track last asked for
     bool musicEnabled = true;
-    bool isPlaying = false;
-    bool shouldLoop = true;
-    
+
+    // background init (initAsync): initThread only touches what openDevice() sets up,
+    // the game thread reads it after initDone
+    bool ready = false;       // game thread: device open, commands accepted
+    bool initStarted = false;
+    bool initOk = false;      // written by initThread before initDone
+    std::atomic<bool> initDone{ false };
+    std::thread initThread;
+    Uint64 initStartNs = 0;
+    int fadeInMs = 0;
+    std::string pendingMusic; // asked for before ready
+    bool subsystemStarted = false; // SDL_InitSubSystem(AUDIO) done (main thread)
+    bool initSubsystem();          // main thread only
+    bool openDevice();             // any thread, after initSubsystem()
+    void joinInit();
+    void releaseDevice();
+
+    // music thread: owns every MusicStream, fills their rings, deletes released ones
+    std::thread musicThread;
+    std::mutex musicMutex;
+    std::condition_variable musicWake;
+    std::vector<std::unique_ptr<MusicStream>> streams;
+    bool musicThreadRunning = false; // guarded by musicMutex
+    void musicThreadMain();
+    void stopMusicThread();
+    void mixMusic(MusicStream* s, float* out, int frames, float g0, float g1);
+
     // Callback để cung cấp audio data
     static void audioCallback(void* userdata, SDL_AudioStream* stream, int additional_amount, int total_amount);
-    void feedAudioData(int neededBytes = 0);
-};
\ No newline at end of file
+    void mix(int frames);
+    void applyCommands();
+    bool loadSound(const std::string& path, Sound& out);
+    bool pushCommand(const Command& cmd);
+
+    // dst[i] += src[i] * gain; ramped: gain goes g0 -> g1 over `frames` frames; clamp to [-1, 1]
+    static void mixAdd(float* dst, const float* src, int count, float gain);
+    static void mixRamp(float* dst, const float* src, int frames, int channels, float g0, float g1);
+    static void clampBuffer(float* buf, int count);
+};
@@ -0,0 +1,208 @@
+#include "capture.h"
+#include <SDL3_image/SDL_image.h>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+bool FrameCapture::parseFormat(const char* name, Format& out)
+{
+    if (!name) return false;
+    if (SDL_strcasecmp(name, "png") == 0) { out = Format::Png; return true; }
+    if (SDL_strcasecmp(name, "y4m") == 0) { out = Format::Y4m; return true; }
+    return false;
+}
+
+bool FrameCapture::start(SDL_Renderer* rend, const std::string& outDir, Format fmt, int rate, bool wait)
+{
+    stop();
+    if (!rend) return false;
+    std::error_code ec;
+    std::filesystem::create_directories(outDir, ec);
+    if (ec) {
+        std::cerr << "FrameCapture::start - cannot create " << outDir << " | " << ec.message() << "\n";
+        return false;
+    }
+    if (fmt == Format::Y4m) {
+        const std::string path = outDir + "/capture.y4m";
+        video = SDL_IOFromFile(path.c_str(), "wb");
+        if (!video) {
+            std::cerr << "FrameCapture::start - cannot open " << path << " | " << SDL_GetError() << "\n";
+            return false;
+        }
+    }
+
+    renderer = rend;
+    dir = outDir;
+    format = fmt;
+    fps = rate > 0 ? rate : 60;
+    waitForBuffers = wait;
+    videoW = videoH = 0;
+    nextWrite = nextIndex = 0;
+    stats = Stats();
+    written.store(0);
+    failed.store(0);
+    pool.clear();
+    freeFrames.clear();
+    for (int i = 0; i < POOL_SIZE; ++i) {
+        pool.push_back(std::make_unique<Frame>());
+        freeFrames.push_back(pool.back().get());
+    }
+    std::cerr << "FrameCapture - " << (fmt == Format::Png ? "png" : "y4m") << " capture to " << outDir
+              << (wait ? " (lossless export)" : "") << "\n";
+    return true;
+}
+
+FrameCapture::Frame* FrameCapture::acquire()
+{
+    std::unique_lock<std::mutex> lock(poolMutex);
+    while (freeFrames.empty()) {
+        if (!waitForBuffers) return nullptr;
+        // export: help with our own encodes instead of sleeping
+        lock.unlock();
+        const bool ran = JobPool::instance().runOne(&jobs);
+        lock.lock();
+        if (!ran && freeFrames.empty()) poolFree.wait_for(lock, std::chrono::milliseconds(1));
+    }
+    Frame* f = freeFrames.back();
+    freeFrames.pop_back();
+    return f;
+}
+
+void FrameCapture::release(Frame* f)
+{
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        freeFrames.push_back(f);
+    }
+    poolFree.notify_one();
+}
+
+void FrameCapture::grab()
+{
+    if (!renderer) return;
+    const Uint64 start = SDL_GetTicksNS();
+    Frame* f = acquire();
+    if (!f) {
+        ++stats.dropped;
+        return;
+    }
+
+    SDL_Surface* shot = SDL_RenderReadPixels(renderer, nullptr);
+    if (!shot) {
+        std::cerr << "FrameCapture::grab - SDL_RenderReadPixels failed | " << SDL_GetError() << "\n";
+        release(f);
+        ++stats.dropped;
+        return;
+    }
+
+    int w = shot->w, h = shot->h;
+    if (format == Format::Y4m) {
+        if (videoW == 0) {
+            // 4:2:0 needs even sizes; the header is written once, before any frame
+            videoW = w & ~1;
+            videoH = h & ~1;
+            char header[96];
+            const int n = SDL_snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n",
+                                       videoW, videoH, fps);
+            SDL_WriteIO(video, header, static_cast<size_t>(n));
+        }
+        if (w < videoW || h < videoH) {
+            // the window shrank: a y4m stream cannot change size
+            SDL_DestroySurface(shot);
+            release(f);
+            ++stats.dropped;
+            return;
+        }
+        w = videoW;
+        h = videoH;
+    }
+
+    const int rowBytes = w * SDL_BYTESPERPIXEL(shot->format);
+    f->pixels.resize(static_cast<size_t>(rowBytes) * h); // no-op once the buffer has been used
+    const uint8_t* src = static_cast<const uint8_t*>(shot->pixels);
+    for (int y = 0; y < h; ++y)
+        std::memcpy(f->pixels.data() + static_cast<size_t>(y) * rowBytes, src + static_cast<size_t>(y) * shot->pitch, rowBytes);
+    f->w = w;
+    f->h = h;
+    f->pitch = rowBytes;
+    f->format = shot->format;
+    f->index = nextIndex++;
+    SDL_DestroySurface(shot);
+
+    ++stats.grabbed;
+    stats.readMs += (SDL_GetTicksNS() - start) / 1e6;
+    JobPool::instance().submit([this, f]() { encode(f); }, &jobs);
+}
+
+void FrameCapture::encode(Frame* f)
+{
+    if (format == Format::Png) {
+        char name[32];
+        SDL_snprintf(name, sizeof(name), "/frame_%06llu.png", static_cast<unsigned long long>(f->index + 1));
+        const std::string path = dir + name;
+        SDL_Surface* s = SDL_CreateSurfaceFrom(f->w, f->h, f->format, f->pixels.data(), f->pitch);
+        const bool ok = s && IMG_SavePNG(s, path.c_str());
+        if (s) SDL_DestroySurface(s);
+        if (ok) {
+            written.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            failed.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "FrameCapture - cannot write " << path << " | " << SDL_GetError() << "\n";
+        }
+        release(f);
+        return;
+    }
+
+    f->yuv.resize(static_cast<size_t>(f->w) * f->h * 3 / 2);
+    f->ok = SDL_ConvertPixels(f->w, f->h, f->format, f->pixels.data(), f->pitch,
+                              SDL_PIXELFORMAT_IYUV, f->yuv.data(), f->w);
+    appendY4m(f);
+}
+
+void FrameCapture::appendY4m(Frame* f)
+{
+    // whoever holds the lock writes every frame that is next in line
+    std::lock_guard<std::mutex> lock(fileMutex);
+    ready[f->index] = f;
+    for (auto it = ready.find(nextWrite); it != ready.end(); it = ready.find(nextWrite)) {
+        Frame* r = it->second;
+        ready.erase(it);
+        ++nextWrite;
+        static const char frameTag[] = "FRAME\n";
+        if (r->ok && SDL_WriteIO(video, frameTag, sizeof(frameTag) - 1) == sizeof(frameTag) - 1 &&
+            SDL_WriteIO(video, r->yuv.data(), r->yuv.size()) == r->yuv.size()) {
+            written.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            // a missing frame only shortens the video; later frames keep their order
+            failed.fetch_add(1, std::memory_order_relaxed);
+        }
+        release(r);
+    }
+}
+
+FrameCapture::Stats FrameCapture::getStats() const
+{
+    Stats s = stats;
+    s.written = written.load(std::memory_order_relaxed);
+    s.failed = failed.load(std::memory_order_relaxed);
+    return s;
+}
+
+void FrameCapture::stop()
+{
+    if (!renderer) return;
+    jobs.wait();
+    if (video) {
+        SDL_CloseIO(video);
+        video = nullptr;
+    }
+    const Stats s = getStats();
+    std::cerr << "FrameCapture - " << s.written << " frames written to " << dir << " (" << s.dropped
+              << " dropped, " << s.failed << " failed), read back "
+              << (s.grabbed ? s.readMs / s.grabbed : 0.0) << " ms/frame\n";
+    renderer = nullptr;
+    ready.clear();
+    freeFrames.clear();
+    pool.clear();
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "jobs.h"
+
+// Gameplay capture: MUMMYMAZE_CAPTURE=png|y4m records every presented frame, and the
+// replay export (MUMMYMAZE_EXPORT) records one frame per simulation tick.
+// grab() runs on the main thread between render and present: SDL_RenderReadPixels, one
+// copy into a free buffer of a small pool, and the buffer goes to the JobPool. Workers
+// either write frame_000001.png, frame_000002.png ... or convert to I420 and append to
+// capture.y4m (uncompressed YUV4MPEG2: mpv/ffplay play it, ffmpeg converts it); y4m
+// frames are appended in capture order whatever order the workers finish in. Buffers
+// are reused: once the pool is warm the only allocation per frame is the surface
+// SDL_RenderReadPixels returns (SDL3 has no read-into-buffer call).
+// When every buffer is still being encoded a live capture drops the frame (counted)
+// rather than stall the game; an export (waitForBuffers) runs encode jobs itself until
+// a buffer is free, so it goes exactly as fast as the encoders and loses nothing.
+class FrameCapture {
+public:
+    enum class Format { Png, Y4m };
+    static const int POOL_SIZE = 8;
+
+    struct Stats {
+        uint64_t grabbed = 0;
+        uint64_t dropped = 0;  // no free buffer (live) or the output size changed (y4m)
+        uint64_t written = 0;
+        uint64_t failed = 0;   // encode / write errors
+        double readMs = 0.0;   // main thread: read back + copy, total
+    };
+
+    FrameCapture() = default;
+    ~FrameCapture() { stop(); }
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // "png" / "y4m"
+    static bool parseFormat(const char* name, Format& out);
+
+    // frames go into `dir` (created if needed); fps is only written in the y4m header
+    bool start(SDL_Renderer* renderer, const std::string& dir, Format format, int fps, bool waitForBuffers);
+    // read back the frame just rendered; call before SDL_RenderPresent
+    void grab();
+    // wait for the encoders, close the file and log the totals
+    void stop();
+    bool isActive() const { return renderer != nullptr; }
+    Stats getStats() const;
+
+private:
+    struct Frame {
+        std::vector<uint8_t> pixels; // as read back, rows packed
+        std::vector<uint8_t> yuv;    // I420 (y4m)
+        int w = 0, h = 0, pitch = 0;
+        SDL_PixelFormat format = SDL_PIXELFORMAT_UNKNOWN;
+        uint64_t index = 0;
+        bool ok = false;
+    };
+
+    SDL_Renderer* renderer = nullptr;
+    std::string dir;
+    Format format = Format::Png;
+    int fps = 60;
+    bool waitForBuffers = false;
+
+    std::vector<std::unique_ptr<Frame>> pool;
+    std::mutex poolMutex;
+    std::condition_variable poolFree;
+    std::vector<Frame*> freeFrames; // guarded by poolMutex
+    JobGroup jobs;
+
+    // y4m: one file, frames appended in index order
+    std::mutex fileMutex;
+    SDL_IOStream* video = nullptr;
+    int videoW = 0, videoH = 0;          // fixed by the first frame (even, for 4:2:0)
+    uint64_t nextWrite = 0;              // guarded by fileMutex
+    std::map<uint64_t, Frame*> ready;    // encoded, waiting for earlier frames
+
+    uint64_t nextIndex = 0;
+    Stats stats;                         // main thread fields
+    std::atomic<uint64_t> written{ 0 };
+    std::atomic<uint64_t> failed{ 0 };
+
+    Frame* acquire();
+    void release(Frame* f);
+    void encode(Frame* f); // worker
+    void appendY4m(Frame* f);
+};
@@ -0,0 +1,73 @@
+#include "catalog.h"
+#include "assets.h"
+#include <iostream>
+#include <sstream>
+
+std::vector<StageInfo> StageCatalog::stages;
+
+void StageCatalog::addBuiltin()
+{
+    for (int i = 1; i <= 3; ++i) {
+        StageInfo s;
+        s.id = i;
+        s.map = "assets/maps/level" + std::to_string(i) + ".txt";
+        s.art = "assets/images/background/background" + std::to_string(i) + ".png";
+        s.theme = std::to_string(i);
+        s.require = i - 1;
+        stages.push_back(s);
+    }
+}
+
+bool StageCatalog::load(const std::string& path)
+{
+    stages.clear();
+    std::string text;
+    if (!Assets::loadText(path, text)) {
+        std::cerr << "StageCatalog::load - cannot read " << path << ", using built-in stages\n";
+        addBuiltin();
+        return false;
+    }
+
+    std::istringstream in(text);
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+
+        std::istringstream ls(line);
+        StageInfo s;
+        if (!(ls >> s.id >> s.map >> s.art >> s.theme)) {
+            std::cerr << "StageCatalog::load - " << path << ":" << lineNo << " malformed, skipped\n";
+            continue;
+        }
+        if (!(ls >> s.require)) s.require = static_cast<int>(stages.size());
+        if (!(ls >> s.music) || s.music == "-") s.music.clear();
+        stages.push_back(std::move(s));
+    }
+
+    if (stages.empty()) {
+        std::cerr << "StageCatalog::load - " << path << " has no stages, using built-in stages\n";
+        addBuiltin();
+        return false;
+    }
+    std::cerr << "StageCatalog::load - " << stages.size() << " stages\n";
+    return true;
+}
+
+int StageCatalog::count() { return static_cast<int>(stages.size()); }
+
+const StageInfo& StageCatalog::get(int index)
+{
+    if (stages.empty()) addBuiltin();
+    if (index < 0) index = 0;
+    if (index >= count()) index = count() - 1;
+    return stages[index];
+}
+
+bool StageCatalog::isUnlocked(int index, int progress)
+{
+    if (index < 0 || index >= count()) return false;
+    return progress >= stages[index].require;
+}
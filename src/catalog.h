@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// One entry of assets/stages.txt.
+struct StageInfo {
+    int id = 0;
+    std::string map;    // level file
+    std::string art;    // background / thumbnail image
+    std::string theme;  // texture suffix for grid, wall and characters
+    int require = 0;    // stages cleared (User::getProgress) needed to unlock
+    std::string music;  // streamed track for the stage, empty = Audio::DEFAULT_MUSIC
+};
+
+// Data-driven list of stages, loaded once at startup.
+// Stages are addressed by their index in the file; progress is "number of stages
+// cleared in catalog order", so index i is normally unlocked once progress >= i.
+class StageCatalog {
+public:
+    // parse the catalog; falls back to the three built-in stages if it is missing or empty
+    static bool load(const std::string& path = "assets/stages.txt");
+
+    static int count();
+    static const StageInfo& get(int index); // index is clamped into range
+    static bool isUnlocked(int index, int progress);
+
+private:
+    static std::vector<StageInfo> stages;
+    static void addBuiltin();
+};
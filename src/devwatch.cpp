@@ -0,0 +1,128 @@
+#include "devwatch.h"
+#include <iostream>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <filesystem>
+#endif
+
+DevWatcher::~DevWatcher() { stop(); }
+
+bool DevWatcher::isDevMode()
+{
+    const char* dev = SDL_getenv("MUMMYMAZE_DEV");
+    return dev && dev[0] && dev[0] != '0';
+}
+
+#ifdef __linux__
+
+bool DevWatcher::start(const std::string& dir)
+{
+    if (running && dir == root) return true;
+    stop();
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "DevWatcher::start - inotify_init1 failed\n";
+        return false;
+    }
+    root = dir;
+    addWatch(dir);
+    std::error_code ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(dir, ec);
+         it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_directory()) addWatch(it->path().generic_string());
+    }
+    running = true;
+    std::cerr << "DevWatcher::start - watching " << dir << " (" << watchDirs.size() << " dirs)\n";
+    return true;
+}
+
+void DevWatcher::addWatch(const std::string& dir)
+{
+    int wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (wd >= 0) watchDirs[wd] = dir;
+}
+
+void DevWatcher::stop()
+{
+    if (fd >= 0) close(fd);
+    fd = -1;
+    watchDirs.clear();
+    running = false;
+}
+
+void DevWatcher::poll(std::vector<std::string>& changed)
+{
+    if (!running) return;
+    alignas(inotify_event) char buf[4096];
+    for (;;) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) break; // EAGAIN: nothing pending
+        for (char* p = buf; p < buf + n; ) {
+            const inotify_event* ev = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + ev->len;
+            auto it = watchDirs.find(ev->wd);
+            if (it == watchDirs.end() || ev->len == 0) continue;
+            std::string path = it->second + "/" + ev->name;
+            if (ev->mask & IN_ISDIR) {
+                if (ev->mask & IN_CREATE) addWatch(path);
+                continue;
+            }
+            // editors usually write a temp file and rename it over the original (IN_MOVED_TO)
+            if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) changed.push_back(path);
+        }
+    }
+}
+
+#else
+
+bool DevWatcher::start(const std::string& dir)
+{
+    if (running && dir == root) return true;
+    stop();
+    root = dir;
+    scan(nullptr);
+    running = true;
+    std::cerr << "DevWatcher::start - polling " << dir << " (" << mtimes.size() << " files)\n";
+    return true;
+}
+
+void DevWatcher::stop()
+{
+    mtimes.clear();
+    running = false;
+}
+
+void DevWatcher::scan(std::vector<std::string>* changed)
+{
+    int count = 0;
+    char** files = SDL_GlobDirectory(root.c_str(), nullptr, 0, &count);
+    if (!files) return;
+    for (int i = 0; i < count; ++i) {
+        std::string path = root + "/" + files[i];
+        for (char& c : path) if (c == '\\') c = '/';
+        SDL_PathInfo info;
+        if (!SDL_GetPathInfo(path.c_str(), &info) || info.type != SDL_PATHTYPE_FILE) continue;
+        auto it = mtimes.find(path);
+        if (it == mtimes.end()) {
+            mtimes[path] = info.modify_time;
+            if (changed) changed->push_back(path);
+        } else if (it->second != info.modify_time) {
+            it->second = info.modify_time;
+            if (changed) changed->push_back(path);
+        }
+    }
+    SDL_free(files);
+}
+
+void DevWatcher::poll(std::vector<std::string>& changed)
+{
+    if (!running) return;
+    Uint64 now = SDL_GetTicks();
+    if (now - lastScan < 500) return; // a few dozen stat calls twice a second
+    lastScan = now;
+    scan(&changed);
+}
+
+#endif
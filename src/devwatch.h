@@ -0,0 +1,37 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// Development-mode file watcher for assets/ (enabled with MUMMYMAZE_DEV=1).
+// Linux uses inotify; other platforms fall back to polling file modification times.
+// Reported paths use the same form the game loads them with, e.g. "assets/maps/level1.txt".
+class DevWatcher {
+public:
+    DevWatcher() = default;
+    ~DevWatcher();
+
+    static bool isDevMode();
+
+    // start watching `dir` recursively; no-op when already watching it
+    bool start(const std::string& dir = "assets");
+    void stop();
+    bool isRunning() const { return running; }
+
+    // non-blocking; appends every path that finished changing since the last call
+    void poll(std::vector<std::string>& changed);
+
+private:
+    bool running = false;
+    std::string root;
+#ifdef __linux__
+    int fd = -1;
+    std::map<int, std::string> watchDirs; // watch descriptor -> directory path
+    void addWatch(const std::string& dir);
+#else
+    Uint64 lastScan = 0;
+    std::map<std::string, SDL_Time> mtimes;
+    void scan(std::vector<std::string>* changed);
+#endif
+};
@@ -0,0 +1,127 @@
+#include "drawlist.h"
+#include "text.h"
+#include <algorithm>
+#include <functional>
+#include <string>
+
+void DrawList::begin(SDL_Renderer* r)
+{
+    renderer = r;
+    quads.clear();
+    pending = Stats{};
+}
+
+void DrawList::push(int layer, SDL_Texture* tex, const SDL_FRect& dst,
+                    float u0, float v0, float u1, float v1, SDL_Color c)
+{
+    Quad q;
+    q.layer = layer;
+    q.tex = tex;
+    q.seq = static_cast<uint32_t>(quads.size());
+    q.dst = dst;
+    q.u0 = u0; q.v0 = v0; q.u1 = u1; q.v1 = v1;
+    q.color = { c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f };
+    quads.push_back(q);
+}
+
+void DrawList::sprite(int layer, SDL_Texture* tex, const SDL_FRect& dst, const SDL_FRect* src, SDL_Color tint)
+{
+    if (!tex) return;
+    ++pending.commands;
+    float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f;
+    if (src) {
+        float tw = 0.0f, th = 0.0f;
+        if (SDL_GetTextureSize(tex, &tw, &th) && tw > 0.0f && th > 0.0f) {
+            u0 = src->x / tw;            v0 = src->y / th;
+            u1 = (src->x + src->w) / tw; v1 = (src->y + src->h) / th;
+        }
+    }
+    push(layer, tex, dst, u0, v0, u1, v1, tint);
+}
+
+void DrawList::fillRect(int layer, const SDL_FRect& r, SDL_Color color)
+{
+    ++pending.commands;
+    push(layer, nullptr, r, 0.0f, 0.0f, 0.0f, 0.0f, color);
+}
+
+void DrawList::fillRects(int layer, const SDL_FRect* rects, int count, SDL_Color color)
+{
+    for (int i = 0; i < count; ++i) fillRect(layer, rects[i], color);
+}
+
+void DrawList::rect(int layer, const SDL_FRect& r, SDL_Color color)
+{
+    ++pending.commands;
+    // four 1-unit strips; the right/bottom ones sit inside the rect like SDL_RenderRect
+    const SDL_FRect top    = { r.x, r.y, r.w, 1.0f };
+    const SDL_FRect bottom = { r.x, r.y + r.h - 1.0f, r.w, 1.0f };
+    const SDL_FRect left   = { r.x, r.y + 1.0f, 1.0f, r.h - 2.0f };
+    const SDL_FRect right  = { r.x + r.w - 1.0f, r.y + 1.0f, 1.0f, r.h - 2.0f };
+    push(layer, nullptr, top, 0, 0, 0, 0, color);
+    push(layer, nullptr, bottom, 0, 0, 0, 0, color);
+    push(layer, nullptr, left, 0, 0, 0, 0, color);
+    push(layer, nullptr, right, 0, 0, 0, 0, color);
+}
+
+void DrawList::text(int layer, const Text& t)
+{
+    if (!t.getTexture()) return;
+    SDL_FRect dst = { static_cast<float>(t.getX()), static_cast<float>(t.getY()),
+                      static_cast<float>(t.getWidth()), static_cast<float>(t.getHeight()) };
+    sprite(layer, t.getTexture(), dst);
+}
+
+void DrawList::flush()
+{
+    if (!renderer) return;
+
+    std::sort(quads.begin(), quads.end(), [](const Quad& a, const Quad& b) {
+        if (a.layer != b.layer) return a.layer < b.layer;
+        if (a.tex != b.tex) return std::less<SDL_Texture*>()(a.tex, b.tex);
+        return a.seq < b.seq;
+    });
+
+    // untextured geometry uses the draw blend mode
+    SDL_BlendMode oldMode = SDL_BLENDMODE_NONE;
+    SDL_GetRenderDrawBlendMode(renderer, &oldMode);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+    size_t i = 0;
+    while (i < quads.size()) {
+        const int layer = quads[i].layer;
+        SDL_Texture* tex = quads[i].tex;
+        vertices.clear();
+        indices.clear();
+        for (; i < quads.size() && quads[i].layer == layer && quads[i].tex == tex; ++i) {
+            const Quad& q = quads[i];
+            const int base = static_cast<int>(vertices.size());
+            const float x0 = q.dst.x, y0 = q.dst.y, x1 = q.dst.x + q.dst.w, y1 = q.dst.y + q.dst.h;
+            vertices.push_back({ { x0, y0 }, q.color, { q.u0, q.v0 } });
+            vertices.push_back({ { x1, y0 }, q.color, { q.u1, q.v0 } });
+            vertices.push_back({ { x1, y1 }, q.color, { q.u1, q.v1 } });
+            vertices.push_back({ { x0, y1 }, q.color, { q.u0, q.v1 } });
+            const int idx[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+            indices.insert(indices.end(), idx, idx + 6);
+        }
+        SDL_RenderGeometry(renderer, tex, vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size()));
+        ++pending.backendCalls;
+    }
+
+    SDL_SetRenderDrawBlendMode(renderer, oldMode);
+    quads.clear();
+    stats = pending;
+    pending = Stats{};
+}
+
+void DrawList::renderStats(float x, float y) const
+{
+    if (!showStats || !renderer) return;
+    const std::string line = "draw list: " + std::to_string(stats.commands) + " cmds -> " +
+                             std::to_string(stats.backendCalls) + " calls";
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderDebugText(renderer, x + 1.0f, y + 1.0f, line.c_str());
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderDebugText(renderer, x, y, line.c_str());
+}
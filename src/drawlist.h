@@ -0,0 +1,73 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <vector>
+
+class Text;
+
+// draw order of the game screen (lower first); other screens pick their own small numbers
+enum DrawLayer {
+    LAYER_FLOOR = 0,
+    LAYER_WALLS,
+    LAYER_OVERLAY,
+    LAYER_MARKERS,
+    LAYER_ACTORS,
+    LAYER_ACTORS_TOP,
+};
+
+// Frame-level draw list.
+// Sprites, filled/outlined rects and text quads are collected with a layer, sorted by
+// layer then texture (stable, so submission order holds inside a run) and every run is
+// sent as one SDL_RenderGeometry call; untextured quads carry their colour per vertex,
+// so all rects of a layer go out together whatever their colours.
+// Inside one layer different textures may be reordered: things that must overlap in a
+// given order go on different layers.
+class DrawList {
+public:
+    struct Stats {
+        int commands = 0;     // sprite()/fillRect()/rect()/text() calls
+        int backendCalls = 0; // SDL_RenderGeometry calls issued
+    };
+
+    // start collecting a frame for `renderer`
+    void begin(SDL_Renderer* renderer);
+
+    void sprite(int layer, SDL_Texture* tex, const SDL_FRect& dst, const SDL_FRect* src = nullptr,
+                SDL_Color tint = {255, 255, 255, 255});
+    void fillRect(int layer, const SDL_FRect& r, SDL_Color color);
+    void fillRects(int layer, const SDL_FRect* rects, int count, SDL_Color color);
+    // 1-unit outline, like SDL_RenderRect
+    void rect(int layer, const SDL_FRect& r, SDL_Color color);
+    // the Text's current texture at its current position
+    void text(int layer, const Text& t);
+
+    // sort and submit everything collected since begin()
+    void flush();
+
+    const Stats& lastStats() const { return stats; }
+
+    // "N cmds -> M calls" in the top-left corner, toggled with F3 by the screens using it
+    void toggleStats() { showStats = !showStats; }
+    bool statsVisible() const { return showStats; }
+    void renderStats(float x = 4.0f, float y = 4.0f) const;
+
+private:
+    struct Quad {
+        int layer;
+        SDL_Texture* tex; // nullptr = solid colour
+        uint32_t seq;     // submission order, keeps the sort stable
+        SDL_FRect dst;
+        float u0, v0, u1, v1;
+        SDL_FColor color;
+    };
+
+    SDL_Renderer* renderer = nullptr;
+    std::vector<Quad> quads;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    Stats pending;
+    Stats stats;
+    bool showStats = false;
+
+    void push(int layer, SDL_Texture* tex, const SDL_FRect& dst, float u0, float v0, float u1, float v1, SDL_Color c);
+};
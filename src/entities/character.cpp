@@ -1,32 +1,49 @@
 #include "character.h"
+#include "../assets.h"
 #include <iostream>
 #include <cmath>
 
 Character::Character(SDL_Renderer *renderer, const std::string &baseName, const std::string &stage, int startX, int startY, int tileSize)
     : renderer(renderer), x(startX), y(startY), tileSize(tileSize), fx((float)startX), fy((float)startY)
 {
-    std::string path = baseName + stage + ".png";
-    texture = IMG_LoadTexture(renderer, path.c_str());
+    texturePath = baseName + stage + ".png";
+    texture = Assets::acquireTexture(renderer, texturePath);
     if (!texture)
-        std::cerr << "Failed to load texture: " << path << " | " << SDL_GetError() << std::endl;
+        std::cerr << "Failed to load texture: " << texturePath << " | " << SDL_GetError() << std::endl;
 }
 
-Character::~Character() { SDL_DestroyTexture(texture); }
+bool Character::reloadTexture(const std::string& path)
+{
+    if (path != texturePath) return false;
+    SDL_Texture* tex = Assets::acquireTexture(renderer, path);
+    if (!tex) return false;
+    Assets::releaseTexture(texture);
+    texture = tex;
+    return true;
+}
+
+Character::~Character() { Assets::releaseTexture(texture); }
+
+void Character::render(DrawList& list, int offsetX, int offsetY, int layer)
+{
+    renderAt(list, fx, fy, offsetX, offsetY, layer);
+}
 
-void Character::render(int offsetX, int offsetY)
+void Character::renderAt(DrawList& list, float atX, float atY, int offsetX, int offsetY, int layer) const
 {
     SDL_FRect rect = {
-        fx * static_cast<float>(tileSize) + static_cast<float>(offsetX),
-        (fy - 1.0f / 4.0f) * static_cast<float>(tileSize) + static_cast<float>(offsetY),
+        atX * static_cast<float>(tileSize) + static_cast<float>(offsetX),
+        (atY - 1.0f / 4.0f) * static_cast<float>(tileSize) + static_cast<float>(offsetY),
         static_cast<float>(tileSize),
         static_cast<float>(tileSize) * 5.0f / 4.0f
     };
-    SDL_RenderTexture(renderer, texture, NULL, &rect);
+    list.sprite(layer, texture, rect);
 }
 
 bool Character::canMoveTo(Map *map, int nx, int ny)
 {
-    return !map->isWall(nx, ny);
+    // một bước sang ô kề: một phép thử bit trên mặt nạ tường của ô hiện tại
+    return map->canStep(x, y, nx - x, ny - y);
 }
 bool Character::isAtRest() const
 {
@@ -38,6 +55,14 @@ void Character::moveTo(int nx, int ny)
     y = ny;
 }
 
+void Character::placeAt(int nx, int ny)
+{
+    x = nx;
+    y = ny;
+    fx = (float)nx;
+    fy = (float)ny;
+}
+
 void Character::updatePosition(float speed)
 {
     fx += (x - fx) * speed;
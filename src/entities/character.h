@@ -8,6 +8,7 @@ class Character {
 protected:
     SDL_Renderer* renderer;
     SDL_Texture* texture;
+    std::string texturePath;
     int x, y;
     int tileSize;
 
@@ -17,9 +18,16 @@ public:
     // baseName: "assets/images/explorer" -> will load baseName + stage + ".png"
     Character(SDL_Renderer* renderer, const std::string& baseName, const std::string& stage, int startX, int startY, int tileSize);
     virtual ~Character();
-    virtual void render(int offsetX = 0, int offsetY = 0);
+    virtual void render(DrawList& list, int offsetX = 0, int offsetY = 0, int layer = LAYER_ACTORS);
+    // draw at a tween position taken from a state snapshot instead of fx/fy
+    void renderAt(DrawList& list, float atX, float atY, int offsetX, int offsetY, int layer) const;
+    float getFx() const { return fx; }
+    float getFy() const { return fy; }
     bool canMoveTo(Map* map, int nx, int ny);
     void moveTo(int nx, int ny);
+    // jump without tweening (level reload)
+    void placeAt(int nx, int ny);
+    bool reloadTexture(const std::string& path);
     bool isAtRest() const;
     void updatePosition(float speed = 0.2f); // gọi mỗi frame để tween
 
@@ -1,7 +1,8 @@
 #include "explorer.h"
+#include <cstdlib>
 
-Explorer::Explorer(SDL_Renderer* renderer, int startX, int startY, int tileSize, char stage)
-    : Character(renderer, "assets/images/explorer/explorer", std::string(1, stage), startX, startY, tileSize) {}
+Explorer::Explorer(SDL_Renderer* renderer, int startX, int startY, int tileSize, const std::string& theme)
+    : Character(renderer, "assets/images/explorer/explorer", theme, startX, startY, tileSize) {}
 
 void Explorer::handleInput(const SDL_Event& e, Map* map) {
     if (e.type != SDL_EVENT_KEY_DOWN) return;
@@ -19,8 +20,26 @@ void Explorer::handleInput(const SDL_Event& e, Map* map) {
         default: return;
     }
 
+    // đi bằng phím thì huỷ đường đi đã click
+    clearRoute();
+
     if (canMoveTo(map, nx, ny)) {
         moveTo(nx, ny);
         moved = true;
     }
-}
\ No newline at end of file
+}
+
+bool Explorer::stepRoute(Map* map) {
+    if (!hasRoute() || fx != x || fy != y) return false;
+
+    const SDL_Point next = route[routePos];
+    if (std::abs(next.x - x) + std::abs(next.y - y) != 1 || !canMoveTo(map, next.x, next.y)) {
+        clearRoute();
+        return false;
+    }
+    ++routePos;
+    if (!hasRoute()) clearRoute();
+    moveTo(next.x, next.y);
+    moved = true;
+    return true;
+}
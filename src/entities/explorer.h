@@ -1,13 +1,25 @@
 #pragma once
 #include "character.h"
+#include <vector>
 
 class Explorer : public Character {
 private:
     bool moved = false; // báo có di chuyển trong lượt
 
+    // click-to-walk: queued tiles, one taken per turn
+    std::vector<SDL_Point> route;
+    size_t routePos = 0;
+
 public:
-    Explorer(SDL_Renderer* renderer, int startX, int startY, int tileSize, char stage);
+    Explorer(SDL_Renderer* renderer, int startX, int startY, int tileSize, const std::string& theme);
     void handleInput(const SDL_Event& e, Map* map);
     bool hasMoved() { return moved; }
     void resetMoveFlag() { moved = false; }
-};
\ No newline at end of file
+
+    void setRoute(const std::vector<SDL_Point>& path) { route = path; routePos = 0; }
+    void clearRoute() { route.clear(); routePos = 0; }
+    bool hasRoute() const { return routePos < route.size(); }
+    const SDL_Point& nextRouteTile() const { return route[routePos]; }
+    // take the next queued step as this turn's move; false (and route dropped) if it is no longer legal
+    bool stepRoute(Map* map);
+};
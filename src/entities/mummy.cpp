@@ -1,10 +1,18 @@
 #include "mummy.h"
 #include <cmath>
 
-Mummy::Mummy(SDL_Renderer* renderer, int startX, int startY, int tileSize, char stage)
-    : Character(renderer, "assets/images/mummy/mummy", std::string(1, stage), startX, startY, tileSize) {}
+Mummy::Mummy(SDL_Renderer* renderer, int startX, int startY, int tileSize, const std::string& theme)
+    : Character(renderer, "assets/images/mummy/mummy", theme, startX, startY, tileSize) {}
 
 void Mummy::moveOneStep(Map* map, int targetX, int targetY) {
+    int nx = x, ny = y;
+    nextStep(map, x, y, targetX, targetY, nx, ny);
+    if (nx != x || ny != y)
+        moveTo(nx, ny);
+    // nếu bí bách xung quanh đều là tường thì đứng im
+}
+
+void Mummy::nextStep(const Map* map, int x, int y, int targetX, int targetY, int& nx, int& ny) {
     int dx = targetX - x;
     int dy = targetY - y;
 
@@ -21,15 +29,15 @@ void Mummy::moveOneStep(Map* map, int targetX, int targetY) {
         dirs[3][0] = 0; dirs[3][1] = -(dirs[0][1]);                      // Y ngược
     }
 
+    nx = x;
+    ny = y;
     for (int i = 0; i < 4; ++i) {
-        int nx = x + dirs[i][0];
-        int ny = y + dirs[i][1];
-        if (canMoveTo(map, nx, ny)) {
-            moveTo(nx, ny);
+        if (map->canStep(x, y, dirs[i][0], dirs[i][1])) {
+            nx = x + dirs[i][0];
+            ny = y + dirs[i][1];
             return;
         }
     }
-    // nếu bí bách xung quanh đều là tường thì đứng im
 }
 
 void Mummy::chase(Map* map, int targetX, int targetY) {
@@ -3,8 +3,12 @@
 
 class Mummy : public Character {
 public:
-    Mummy(SDL_Renderer* renderer, int startX, int startY, int tileSize, char stage);
+    Mummy(SDL_Renderer* renderer, int startX, int startY, int tileSize, const std::string& theme);
 
     void moveOneStep(Map* map, int targetX, int targetY);
     void chase(Map* map, int targetX, int targetY);
-};
\ No newline at end of file
+
+    // pure rule used by moveOneStep: where a mummy at (x,y) goes when chasing (targetX,targetY).
+    // (nx,ny) == (x,y) when every direction is blocked. Reference for Bitboard::mummyStep.
+    static void nextStep(const Map* map, int x, int y, int targetX, int targetY, int& nx, int& ny);
+};
@@ -1,38 +1,159 @@
 #include "game.h"
 #include "audio.h"
-#include "start.h"
+#include "assets.h"
+#include "jobs.h"
 #include <cmath>
-static const int MAX_STAGE = 3;
 
-void Game::init(char stage)
+extern Audio* g_audioInstance;
+
+bool Game::enter(SceneManager* sm)
 {
-    currentStage = stage;
+    scenes = sm;
+    window = sm->getWindow();
+    renderer = sm->getRenderer();
+    if (!buildPanels()) std::cerr << "Game::enter - failed to build result panels\n";
+    init(startStage);
+    return map != nullptr;
+}
+
+void Game::exit() { cleanup(); }
+
+void Game::setPlayback(Replay replay)
+{
+    playback = std::move(replay);
+    playingBack = true;
+    startStage = static_cast<int>(playback.stage);
+}
+
+bool Game::buildPanels()
+{
+    const Uint64 start = SDL_GetPerformanceCounter();
+    const int panelW = 1750, panelH = 900;
+    const int px = (winW - panelW) / 2;
+    const int py = (winH - panelH) / 2;
+    bool ok = true;
+
+    settingsPanel = new SettingsPanel(renderer);
+    // Truyền isInGame = true; RETURN chỉ ẩn panel, panel được giữ lại cho lần mở sau
+    if (settingsPanel->init(&user, panelW, panelH,
+        [this]() { settingsVisible = false; },
+        true, // isInGame = true
+        [this]() {
+            // về Start menu; scene bị pop sau frame này nên panel không bị xóa khi đang chạy
+            scenes->pop();
+        })) {
+        settingsPanel->setPosition(px, py);
+    } else {
+        delete settingsPanel;
+        settingsPanel = nullptr;
+        ok = false;
+    }
+
+    victoryPanel = new VictoryPanel(renderer);
+    if (victoryPanel->init(panelW, panelH)) {
+        victoryPanel->setPosition(px, py);
+    } else {
+        delete victoryPanel;
+        victoryPanel = nullptr;
+        ok = false;
+    }
+
+    lostPanel = new LostPanel(renderer);
+    if (lostPanel->init(panelW, panelH)) {
+        lostPanel->setPosition(px, py);
+    } else {
+        delete lostPanel;
+        lostPanel = nullptr;
+        ok = false;
+    }
+
+    // Tạo text "THE END" bằng class Text có sẵn trong project
+    SDL_Color color = {255, 255, 255, 255};
+    if (theEndText.create(renderer, "assets/font.ttf", 120, "THE END", color)) {
+        int x = (winW - theEndText.getWidth()) / 2;
+        int y = (winH - theEndText.getHeight()) / 2;
+        theEndText.setPosition(x, y);
+    } else {
+        ok = false;
+    }
+
+    // composite now so the first frame that shows a panel only draws its cache
+    if (settingsPanel) settingsPanel->prewarm();
+    if (victoryPanel) victoryPanel->prewarm();
+    if (lostPanel) lostPanel->prewarm();
+
+    const double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    std::cerr << "Game::buildPanels - " << ms << " ms\n";
+    return ok;
+}
+
+void Game::init(int stageIndex)
+{
+    currentStage = stageIndex;
+    const StageInfo& info = StageCatalog::get(stageIndex);
     gameState = GameState::Playing;
     turn = 0;  // Thêm dòng này
     mummyStepsLeft = 0;  // Thêm dòng này
     settingsVisible = false;  // Thêm dòng này
-    
-    // Chỉ init SDL nếu chưa có window
-    if (!renderer)
-        renderer = SDL_CreateRenderer(window, NULL);
-    
-    // Khởi tạo User (giống như trong Start)
-    user.read();
+    simPhase = GameState::Playing;
+    pendingStage = -1;
+    commands.clear();
+    resetTiming();
+    moveCount = 0;
+    recording.clear();
+    recordRun = !playingBack && recordEnabled(); // before the sim thread starts
+    recording.stage = static_cast<uint32_t>(stageIndex);
+    recording.stageId = info.id;
+    playbackPos = 0;
+    playbackTail = 0;
+
+    // nhạc của màn, crossfade từ bài đang phát (cùng bài thì phát tiếp)
+    if (g_audioInstance)
+        g_audioInstance->playMusic(info.music.empty() ? Audio::DEFAULT_MUSIC : info.music, 1500);
+
+    // Khởi tạo User từ cache của UserStore (không đọc file)
     user.Init();
 
+    // giải mã song song mọi ảnh của màn trên JobPool; các loadTexture bên dưới chỉ còn upload
+    // (background đi qua ImageCache nên không cần giải mã)
+    const Uint64 loadStart = SDL_GetPerformanceCounter();
+    const std::string& st = info.theme;
+    Assets::prefetch({
+        "assets/images/grid/lightGrid" + st + ".png",
+        "assets/images/grid/darkGrid" + st + ".png",
+        "assets/images/wall/wall" + st + ".png",
+        "assets/images/grid/exit1.jpg",
+        "assets/images/explorer/explorer" + st + ".png",
+        "assets/images/mummy/mummy" + st + ".png",
+        "assets/images/panel/ingamePanel.png",
+        "assets/images/title.png",
+        "assets/images/button/button_normal.png",
+        "assets/images/button/button_onClick.png",
+    });
+
     // background manager
-    background = new Background(renderer);
-    background->load(stage);
+    background = levelArena.make<Background>(renderer);
+    background->load(info.art);
 
-    map = new Map(renderer, stage);
-    map->loadFromFile("assets/maps/level" + std::string(1, stage) + ".txt");
+    map = levelArena.make<Map>(renderer, info.theme);
+    mapPath = info.map;
+    map->loadFromFile(mapPath);
+    // cross-check O(cells^2) và đo tốc độ: chỉ trong dev mode (bản phát hành không định nghĩa NDEBUG)
+    if (bitboard.build(map) && DevWatcher::isDevMode()) {
+        if (!bitboard.verifyAgainst(map))
+            std::cerr << "Game::init - bitboard rules disagree with Map/Mummy rules\n";
+        bitboard.benchmarkAgainst(map);
+    }
+    pathCache.reset(&bitboard);
+    hoverTileX = hoverTileY = -1;
+    hoverPath.clear();
     int tileSize = map->getTileSize();
     int mapPxW = tileSize * map->getCols();
     int mapPxH = tileSize * map->getRows();
     offsetX = (winW - mapPxW) * 95 / 100;
     offsetY = (winH - mapPxH) / 2;
 
-    ingamePanel = new IngamePanel(renderer);
+    ingamePanel = levelArena.make<IngamePanel>(renderer);
     ingamePanel->create(renderer, 0, 0, 0, 0);
     ingamePanel->initForStage(this, winW, mapPxW, winH, mapPxH);
 
@@ -40,91 +161,213 @@ void Game::init(char stage)
     int mummyX = 5, mummyY = 5;  // default fallback
     map->getExplorerPosition(expX, expY);
     map->getMummyPosition(mummyX, mummyY);
+
+    // level validator: exit must be reachable from the explorer start
+    map->getExitPosition(exitX, exitY);
+    if (bitboard.getRows() > 0 && !Bitboard::test(bitboard.reachable(expX, expY), exitX, exitY))
+        std::cerr << "Game::init - exit is not reachable from explorer start in stage " << info.id << "\n";
     
-    explorer = new Explorer(renderer, expX, expY, tileSize, stage);
-    mummy = new Mummy(renderer, mummyX, mummyY, tileSize, stage);
+    explorer = levelArena.make<Explorer>(renderer, expX, expY, tileSize, info.theme);
+    mummy = levelArena.make<Mummy>(renderer, mummyX, mummyY, tileSize, info.theme);
+    dangerOverlay.invalidate();
 
-    isRunning = true;
+    Assets::dropPrefetched();
+    const double loadMs = (SDL_GetPerformanceCounter() - loadStart) * 1000.0 / SDL_GetPerformanceFrequency();
+    std::cerr << "Game::init - stage " << info.id << " loaded in " << loadMs << " ms ("
+              << JobPool::instance().workerCount() << " decode workers)\n";
+
+    if (DevWatcher::isDevMode()) devWatcher.start("assets");
+
+    // trạng thái đầu tiên cho render, rồi mới cho simulation chạy riêng (nếu bật)
+    const char* simEnv = SDL_getenv("MUMMYMAZE_SIM_THREAD");
+    useSimThread = !playingBack && simEnv && simEnv[0] && simEnv[0] != '0';
+    levelStartNs = SDL_GetTicksNS();
+    finishNs = 0;
+    snapshots.reset(Snapshot{});
+    publishSnapshot();
+    frame = &snapshots.latest();
+    startSim();
 }
 
-void Game::handleEvents()
+void Game::handleEvents(const std::vector<SDL_Event>& events)
 {
-    SDL_Event e;
-    int curW = winW;
-    int curH = winH;
-    while (SDL_PollEvent(&e))
+    if (playingBack) return; // the replay is the only input
+
+    // mouse motion is coalesced: only the last position of this frame updates the hover path
+    bool hoverPending = false;
+    float hoverX = 0.0f, hoverY = 0.0f;
+    for (const SDL_Event& e : events)
     {
         if (gameState == GameState::TheEnd) {
             if (e.type == SDL_EVENT_MOUSE_BUTTON_DOWN ||
-                e.type == SDL_EVENT_KEY_DOWN ||
-                e.type == SDL_EVENT_QUIT) {
-
-                // Tắt game hiện tại
-                isRunning = false;
-                cleanup();   // đóng cửa sổ game, giải phóng tài nguyên
-
-                // Mở lại Start menu
-                Start start;
-                start.run(window);
-                return;      // Thoát hàm handleEvents
+                e.type == SDL_EVENT_KEY_DOWN) {
+                // quay về Start menu (nằm ngay dưới scene này)
+                scenes->pop();
+                return;
             }
             // Nếu không có input trên thì bỏ qua event
             continue;
         }
-        if (e.type == SDL_EVENT_QUIT)
-            isRunning = false;
-
-        // forward input to UI panels so buttons get clicks
-        bool panelActive = false;
-        if (settingsVisible && settingsPanel) {
-            settingsPanel->handleEvent(e);
-            panelActive = true;
-        }
-        if (gameState == GameState::Victory && victoryPanel) {
-            victoryPanel->handleEvent(e);
-            panelActive = true;
-        }
-        if (gameState == GameState::Lost && lostPanel) {
-            lostPanel->handleEvent(e);
-            panelActive = true;
+
+        // forward input to the topmost UI panel only (settings over victory/lost over ingame)
+        Panel* modal = nullptr;
+        if (settingsVisible && settingsPanel) modal = settingsPanel;
+        else if (gameState == GameState::Victory && victoryPanel) modal = victoryPanel;
+        else if (gameState == GameState::Lost && lostPanel) modal = lostPanel;
+        const bool panelActive = modal != nullptr;
+        if (modal) modal->handleEvent(e);
+        else if (ingamePanel) ingamePanel->handleEvent(e);
+
+        if (!panelActive && e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_D) {
+            SimCommand cmd;
+            cmd.kind = SimCommand::Kind::ToggleDanger;
+            queueCommand(cmd);
         }
-        if (!panelActive && ingamePanel) {
-            ingamePanel->handleEvent(e);
+        if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F3)
+            drawList.toggleStats();
+
+        if (e.type == SDL_EVENT_MOUSE_MOTION) {
+            hoverPending = !panelActive;
+            hoverX = e.motion.x;
+            hoverY = e.motion.y;
         }
 
-        if (e.type == SDL_EVENT_WINDOW_RESIZED)
-        {
-            int w = e.window.data1;
-            int h = e.window.data2;
-            if (w != curW)
-            {
-                h = static_cast<int>(w / windowRatio);
-            }
-            else if (h != curH)
-            {
-                w = static_cast<int>(h * windowRatio);
-            }
-            SDL_SetWindowSize(window, w, h);
-            float scale = static_cast<float>(w) / static_cast<float>(winW);
-            SDL_SetRenderScale(renderer, scale, scale);
-            curW = w;
-            curH = h;
+        if (panelActive || gameState != GameState::Playing) continue;
+
+        // click vào ô sàn: simulation tìm đường và xếp hàng, mỗi lượt đi một ô
+        if (e.type == SDL_EVENT_MOUSE_BUTTON_DOWN && e.button.button == SDL_BUTTON_LEFT) {
+            SimCommand cmd;
+            cmd.kind = SimCommand::Kind::Click;
+            if (screenToTile(e.button.x, e.button.y, cmd.tx, cmd.ty)) queueCommand(cmd);
         }
+        if (e.type == SDL_EVENT_KEY_DOWN) {
+            SimCommand cmd;
+            cmd.kind = SimCommand::Kind::Key;
+            cmd.event = e;
+            queueCommand(cmd);
+        }
+    }
 
-        if (!panelActive && turn == 0)
-            explorer->handleInput(e, map);
+    if (hoverPending) {
+        SimCommand cmd;
+        cmd.kind = SimCommand::Kind::Hover;
+        if (!screenToTile(hoverX, hoverY, cmd.tx, cmd.ty)) cmd.tx = cmd.ty = -1;
+        queueCommand(cmd);
     }
 }
 
+void Game::queueCommand(SimCommand cmd)
+{
+    cmd.queuedNs = SDL_GetTicksNS();
+    if (!commands.push(cmd))
+        std::cerr << "Game::queueCommand - simulation queue full, input dropped\n";
+}
+
 void Game::update()
 {
-    // tween vị trí mỗi frame
+    // next level / retry: load here, not inside the panel callback that asked for it
+    if (pendingStage >= 0) {
+        const int stage = pendingStage;
+        pendingStage = -1;
+        cleanupForRestart();
+        init(stage);
+    }
+    if (devWatcher.isRunning()) applyHotReload();
+
+    if (!useSimThread) simulate();
+    present();
+    // playback: show the end of the run for a second, then leave (export ends with the scene)
+    if (playingBack && (gameState != GameState::Playing || simTicks > playback.ticks + 5ull * SIM_HZ) &&
+        ++playbackTail == SIM_HZ) {
+        if (gameState == GameState::Playing)
+            std::cerr << "Game - replay did not reach the end of the run (map changed?)\n";
+        scenes->pop();
+    }
+    if (gameState == GameState::Victory && victoryPanel && user.boardVersion() != shownBoardVersion)
+        refreshVictoryBoard();
+}
+
+void Game::simulate()
+{
+    const Uint64 tickStart = SDL_GetTicksNS();
+
+    // playback: the commands recorded for this tick, through the same queue
+    while (playingBack && playbackPos < playback.events.size() && playback.events[playbackPos].tick <= simTicks) {
+        const Replay::Event& ev = playback.events[playbackPos++];
+        SimCommand c;
+        c.kind = static_cast<SimCommand::Kind>(ev.kind);
+        if (c.kind == SimCommand::Kind::Key) {
+            c.event.type = SDL_EVENT_KEY_DOWN;
+            c.event.key.key = static_cast<SDL_Keycode>(ev.key);
+            c.event.key.scancode = static_cast<SDL_Scancode>(ev.scancode);
+            c.event.key.mod = static_cast<SDL_Keymod>(ev.mod);
+            c.event.key.repeat = ev.repeat != 0;
+            c.event.key.down = true;
+        }
+        c.tx = ev.tx;
+        c.ty = ev.ty;
+        queueCommand(c);
+    }
+
+    SimCommand cmd;
+    while (commands.pop(cmd)) {
+        inputTotalMs += (tickStart - cmd.queuedNs) / 1e6;
+        ++inputCount;
+        if (recordRun && simPhase == GameState::Playing && cmd.kind != SimCommand::Kind::Hover) {
+            Replay::Event ev;
+            ev.tick = static_cast<uint32_t>(simTicks);
+            ev.kind = static_cast<uint8_t>(cmd.kind);
+            if (cmd.kind == SimCommand::Kind::Key) {
+                ev.key = static_cast<int32_t>(cmd.event.key.key);
+                ev.scancode = static_cast<int32_t>(cmd.event.key.scancode);
+                ev.mod = static_cast<uint16_t>(cmd.event.key.mod);
+                ev.repeat = cmd.event.key.repeat ? 1 : 0;
+            }
+            ev.tx = cmd.tx;
+            ev.ty = cmd.ty;
+            recording.events.push_back(ev);
+        }
+        switch (cmd.kind) {
+        case SimCommand::Kind::Key:
+            if (turn == 0 && simPhase == GameState::Playing) explorer->handleInput(cmd.event, map);
+            break;
+        case SimCommand::Kind::Click:
+            if (turn == 0 && simPhase == GameState::Playing) {
+                std::vector<SDL_Point> path;
+                if (pathCache.findPath(explorer->getX(), explorer->getY(), cmd.tx, cmd.ty, path))
+                    explorer->setRoute(path);
+            }
+            break;
+        case SimCommand::Kind::Hover:
+            hoverTileX = cmd.tx;
+            hoverTileY = cmd.ty;
+            break;
+        case SimCommand::Kind::ToggleDanger:
+            dangerOverlay.toggle();
+            break;
+        }
+    }
+
+    // tween vị trí mỗi tick
     explorer->updatePosition();
     mummy->updatePosition();
 
+    // đi theo đường đã click: một ô mỗi lượt, dừng nếu ô kế tiếp để mummy bắt được
+    if (turn == 0 && simPhase == GameState::Playing && explorer->hasRoute() &&
+        explorer->isAtRest() && mummy->isAtRest()) {
+        const SDL_Point next = explorer->nextRouteTile();
+        int mx = mummy->getX(), my = mummy->getY();
+        if (DangerOverlay::caughtThisTurn(bitboard, next.x, next.y, mx, my)) {
+            explorer->clearRoute();
+        } else {
+            explorer->stepRoute(map);
+        }
+    }
+
     // Nếu đang là lượt người chơi và người chơi vừa đi xong → bắt đầu lượt mummy (2 bước)
     if (turn == 0 && explorer->hasMoved())
     {
+        ++moveCount;
         turn = 1;
         mummyStepsLeft = 2;
         explorer->resetMoveFlag();
@@ -144,149 +387,248 @@ void Game::update()
             turn = 0;
         }
     }
-    if (gameState == GameState::Playing && explorer && map) {
-        if (map->isExit(explorer->getX(), explorer->getY())) {
-    
-            // Nếu đang ở màn tối đa (3) → chuyển sang màn hình THE END
-                    // Nếu đang ở màn tối đa (3) → chuyển sang màn hình THE END
-        if ((currentStage - '0') >= MAX_STAGE) {
-            gameState = GameState::TheEnd;
+    // danger overlay: chỉ tính lại khi tới lượt người chơi và vị trí đã thay đổi
+    if (dangerOverlay.isVisible() && turn == 0 && simPhase == GameState::Playing &&
+        explorer->isAtRest() && mummy->isAtRest()) {
+        dangerOverlay.update(bitboard, explorer->getX(), explorer->getY(),
+                             mummy->getX(), mummy->getY(), exitX, exitY);
+    }
 
-            // Tạo text "THE END" bằng class Text có sẵn trong project
-            SDL_Color color = {255, 255, 255, 255};
-            if (theEndText.create(renderer, "assets/font.ttf", 120, "THE END", color)) {
-                int x = (winW - theEndText.getWidth()) / 2;
-                int y = (winH - theEndText.getHeight()) / 2;
-                theEndText.setPosition(x, y);
-            }
+    // tới cửa ra → thắng; trùng ô với mummy → thua. Panel do present() tạo trên main thread
+    if (simPhase == GameState::Playing && map->isExit(explorer->getX(), explorer->getY()))
+        simPhase = GameState::Victory;
+    if (simPhase == GameState::Playing &&
+        explorer->getX() == mummy->getX() && explorer->getY() == mummy->getY())
+        simPhase = GameState::Lost;
+    if (simPhase != GameState::Playing && !finishNs) {
+        finishNs = SDL_GetTicksNS();
+        recording.ticks = static_cast<uint32_t>(simTicks + 1);
+    }
+
+    // gợi ý đường đi theo ô chuột đang chỉ
+    if (hoverTileX < 0 || turn != 0 || simPhase != GameState::Playing || explorer->hasRoute() ||
+        !pathCache.findPath(explorer->getX(), explorer->getY(), hoverTileX, hoverTileY, hoverPath))
+        hoverPath.clear();
+
+    const double ms = (SDL_GetTicksNS() - tickStart) / 1e6;
+    ++simTicks;
+    simTotalMs += ms;
+    if (ms > simMaxMs) simMaxMs = ms;
+    publishSnapshot();
+}
+
+void Game::publishSnapshot()
+{
+    Snapshot& s = snapshots.back();
+    s.tick = simTicks;
+    s.phase = simPhase;
+    s.turn = turn;
+    s.explorerFx = explorer->getFx();
+    s.explorerFy = explorer->getFy();
+    s.mummyFx = mummy->getFx();
+    s.mummyFy = mummy->getFy();
+    s.hoverPath = hoverPath;
+    s.danger = dangerOverlay;
+    s.simTicks = simTicks;
+    s.simAvgMs = simTicks ? simTotalMs / simTicks : 0.0;
+    s.simMaxMs = simMaxMs;
+    s.inputAvgMs = inputCount ? inputTotalMs / inputCount : 0.0;
+    s.publishedNs = SDL_GetTicksNS();
+    s.moves = moveCount;
+    s.playNs = (finishNs ? finishNs : s.publishedNs) - levelStartNs;
+    if (playingBack) s.playNs = simTicks * (SDL_NS_PER_SECOND / SIM_HZ); // recorded pace, not export speed
+    snapshots.publish();
+}
+
+void Game::simLoop()
+{
+    const Uint64 stepNs = SDL_NS_PER_SECOND / SIM_HZ;
+    Uint64 next = SDL_GetTicksNS();
+    while (simRunning.load(std::memory_order_acquire)) {
+        simulate();
+        next += stepNs;
+        const Uint64 now = SDL_GetTicksNS();
+        if (now < next) SDL_DelayPrecise(next - now);
+        else if (now - next > stepNs * 4) next = now; // bị treo lâu: không chạy bù hàng loạt tick
+    }
+}
+
+void Game::startSim()
+{
+    if (!useSimThread || simThread.joinable()) return;
+    simRunning.store(true, std::memory_order_release);
+    simThread = std::thread([this]() { simLoop(); });
+}
+
+void Game::stopSim()
+{
+    if (!simThread.joinable()) return;
+    simRunning.store(false, std::memory_order_release);
+    simThread.join();
+}
+
+void Game::present()
+{
+    const Snapshot& s = snapshots.latest();
+    frame = &s;
+    if (gameState != GameState::Playing || s.phase == GameState::Playing) return;
+
+    // kết quả lượt chơi: chỉ xếp hàng cho writer của UserStore, không đụng tới file ở đây
+    // (replay không tính vào thống kê / tiến độ)
+    const int playMs = static_cast<int>(s.playNs / 1000000);
+    shownBoardVersion = user.boardVersion(); // bảng xếp hạng hiện khi writer gộp xong lượt này
+    if (!playingBack) {
+        user.recordResult(StageCatalog::get(currentStage).id, s.phase == GameState::Victory, s.moves, playMs);
+        saveRecording();
+    }
+
+    if (s.phase == GameState::Victory) {
+        if (!playingBack) user.updateProgress(currentStage + 1); // đã qua màn này
+
+        // Nếu đang ở màn cuối của catalog → chuyển sang màn hình THE END
+        if (currentStage + 1 >= StageCatalog::count()) {
+            // "THE END" đã tạo sẵn trong buildPanels()
+            gameState = GameState::TheEnd;
         } else {
             // Ngược lại: xử lý thắng bình thường, hiện VictoryPanel + nút Next
             gameState = GameState::Victory;
-            if (currentStage >= '1' && currentStage <= '2') {
-                user.updateStage(currentStage + 1);
-            }
-                if (!victoryPanel) {
-                    victoryPanel = new VictoryPanel(renderer);
-                    if (victoryPanel->init(1750, 900, [this]() {
-                        // Next level callback - restart game với stage mới
-                        char nextStage = currentStage + 1;
-                        std::cerr << "Loading next level: " << nextStage << "\n";  // Debug
-                        cleanupForRestart();
-                        init(nextStage);
-                        std::cerr << "Next level loaded\n";  // Debug
-                    })) {
-                        int px = (winW - victoryPanel->getWidth()) / 2;
-                        int py = (winH - victoryPanel->getHeight()) / 2;
-                        victoryPanel->setPosition(px, py);
-                    }
-                }
+            if (victoryPanel) {
+                victoryPanel->open([this]() {
+                    // Next level callback - load ở update() frame sau
+                    std::cerr << "Loading next level: " << currentStage + 1 << "\n";  // Debug
+                    pendingStage = currentStage + 1;
+                });
+                victoryPanel->setResult(s.moves, playMs);
             }
         }
-    }
-
-    // Check collision: Mummy với Explorer (Lost)
-    if (gameState == GameState::Playing && explorer && mummy) {
-        if (explorer->getX() == mummy->getX() && explorer->getY() == mummy->getY()) {
-            gameState = GameState::Lost;
-            // Tạo lost panel
-            if (!lostPanel) {
-                lostPanel = new LostPanel(renderer);
-                if (lostPanel->init(1750, 900, [this]() {
-                    // Play again callback - restart current level
-                    cleanupForRestart();
-                    init(currentStage);
-                })) {
-                    int px = (winW - lostPanel->getWidth()) / 2;
-                    int py = (winH - lostPanel->getHeight()) / 2;
-                    lostPanel->setPosition(px, py);
-                }
-            }
+    } else if (s.phase == GameState::Lost) {
+        gameState = GameState::Lost;
+        if (lostPanel) {
+            lostPanel->open([this]() {
+                // Play again callback - restart current level
+                pendingStage = currentStage;
+            });
         }
     }
 }
 
+bool Game::recordEnabled()
+{
+    const char* env = SDL_getenv("MUMMYMAZE_RECORD");
+    return env && env[0] && env[0] != '0';
+}
+
+void Game::saveRecording()
+{
+    if (!recordRun) return;
+    // the sim stopped adding events when the phase left Playing; the copy goes to a worker
+    const std::string path = "replays/stage" + std::to_string(recording.stageId) + ".mmr";
+    JobPool::instance().submit([r = recording, path]() {
+        if (r.save(path))
+            std::cerr << "Game - replay saved to " << path << " (" << r.ticks << " ticks, " << r.events.size() << " events)\n";
+    });
+}
+
+void Game::refreshVictoryBoard()
+{
+    LevelStats mine;
+    size_t rank = 0, ranked = 0;
+    std::vector<Leaderboards::Standing> top;
+    if (!user.levelBoard(StageCatalog::get(currentStage).id, VictoryPanel::TOP_ROWS, mine, rank, ranked, top)) return;
+    shownBoardVersion = user.boardVersion();
+    victoryPanel->setRecord(mine, rank, ranked, top);
+}
+
 void Game::render()
 {
+    const Uint64 frameStart = SDL_GetTicksNS();
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
     SDL_RenderClear(renderer);
 
     // ===== THÊM KHỐI XỬ LÝ THE END TẠI ĐÂY =====
     if (gameState == GameState::TheEnd) {
         theEndText.render();
-        SDL_RenderPresent(renderer);
-        return; 
+        return;
     }
     // ===== HẾT KHỐI THE END =====
 
+    const Snapshot& s = *frame;
     if (background) background->render(winW, winH);
-    map->render(offsetX, offsetY);
-    explorer->render(offsetX, offsetY);
-    mummy->render(offsetX, offsetY);
+    drawList.begin(renderer);
+    map->render(drawList, offsetX, offsetY);
+    if (gameState == GameState::Playing && s.turn == 0 && s.danger.isVisible())
+        s.danger.render(drawList, offsetX, offsetY, map->getTileSize());
+    renderHoverPath(s);
+    explorer->renderAt(drawList, s.explorerFx, s.explorerFy, offsetX, offsetY, LAYER_ACTORS);
+    mummy->renderAt(drawList, s.mummyFx, s.mummyFy, offsetX, offsetY, LAYER_ACTORS_TOP);
+    drawList.flush();
     if (ingamePanel) ingamePanel->render();
     if (settingsVisible && settingsPanel) settingsPanel->render();
     if (gameState == GameState::Victory && victoryPanel) victoryPanel->render();
     if (gameState == GameState::Lost && lostPanel) lostPanel->render();
+    drawList.renderStats();
+    renderTiming();
 
-    SDL_RenderPresent(renderer);
+    const double ms = (SDL_GetTicksNS() - frameStart) / 1e6;
+    ++renderFrames;
+    renderTotalMs += ms;
+    if (ms > renderMaxMs) renderMaxMs = ms;
+    ageTotalMs += (frameStart - s.publishedNs) / 1e6;
 }
 
-void Game::cleanup()
+void Game::resetTiming()
 {
-    if (background) {
-        background->cleanup();
-        delete background;
-        background = nullptr;
-    }
+    simTicks = 0;
+    simTotalMs = simMaxMs = inputTotalMs = 0.0;
+    inputCount = 0;
+    renderFrames = 0;
+    renderTotalMs = renderMaxMs = ageTotalMs = 0.0;
+}
 
-    if (ingamePanel) {
-        ingamePanel->cleanup();
-        delete ingamePanel;
-        ingamePanel = nullptr;
-    }
-    if (settingsPanel) {
-        settingsPanel->cleanup();
-        delete settingsPanel;
-        settingsPanel = nullptr;
-    }
-    if (victoryPanel) {
-        victoryPanel->cleanup();
-        delete victoryPanel;
-        victoryPanel = nullptr;
-    }
-    if (lostPanel) {
-        lostPanel->cleanup();
-        delete lostPanel;
-        lostPanel = nullptr;
-    }
-    
-    delete map;
-    map = nullptr;
+void Game::reportTiming()
+{
+    if (!explorer || renderFrames == 0) return;
+    const Snapshot& s = snapshots.latest();
+    std::cerr << "Game timing - sim (" << (useSimThread ? "thread" : "inline") << "): " << s.simTicks
+              << " ticks avg " << s.simAvgMs << " ms max " << s.simMaxMs << " ms, input->sim avg "
+              << s.inputAvgMs << " ms | render: " << renderFrames << " frames avg "
+              << renderTotalMs / renderFrames << " ms max " << renderMaxMs << " ms, snapshot age avg "
+              << ageTotalMs / renderFrames << " ms\n";
+}
 
-    delete explorer;
-    explorer = nullptr;
+void Game::renderTiming() const
+{
+    if (!drawList.statsVisible() || !frame) return;
+    char line[160];
+    SDL_snprintf(line, sizeof(line), "sim %s: %.3f ms (max %.3f), input %.2f ms | render %.3f ms (max %.3f)",
+                 useSimThread ? "thread" : "inline", frame->simAvgMs, frame->simMaxMs, frame->inputAvgMs,
+                 renderFrames ? renderTotalMs / renderFrames : 0.0, renderMaxMs);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderDebugText(renderer, 5.0f, 17.0f, line);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderDebugText(renderer, 4.0f, 16.0f, line);
+}
 
-    delete mummy;
+void Game::releaseLevel()
+{
+    stopSim();
+    reportTiming();
+    const LevelArena::Stats& st = levelArena.getStats();
+    if (st.objects) std::cerr << "Game - stage " << StageCatalog::get(currentStage).id << " arena: " << st.objects << " objects, "
+              << st.bytes / 1024.0 << " KB (peak " << st.peakBytes / 1024.0 << " KB, " << st.chunks
+              << " chunks), " << st.heapAllocs << " new chunks\n";
+    background = nullptr;
+    map = nullptr;
+    ingamePanel = nullptr;
+    explorer = nullptr;
     mummy = nullptr;
-
-    SDL_DestroyRenderer(renderer);
-    renderer = nullptr;
-
-    theEndText.cleanup();
-
-    isRunning = false;
+    levelArena.reset(); // destructors free textures / children, chunks stay for the next stage
 }
-void Game::cleanupForRestart()
+
+void Game::cleanup()
 {
-    if (background) {
-        background->cleanup();
-        delete background;
-        background = nullptr;
-    }
-    if (ingamePanel) {
-        ingamePanel->cleanup();
-        delete ingamePanel;
-        ingamePanel = nullptr;
-    }
+    releaseLevel();
+    levelArena.release();
     if (settingsPanel) {
         settingsPanel->cleanup();
         delete settingsPanel;
@@ -302,13 +644,17 @@ void Game::cleanupForRestart()
         delete lostPanel;
         lostPanel = nullptr;
     }
-    delete map;
-    map = nullptr;
-    delete explorer;
-    explorer = nullptr;
-    delete mummy;
-    mummy = nullptr;
+
     theEndText.cleanup();
+    devWatcher.stop();
+
+    // renderer thuộc SceneManager, dùng tiếp cho Start menu
+    renderer = nullptr;
+}
+void Game::cleanupForRestart()
+{
+    releaseLevel();
+    // settings / victory / lost panels và THE END giữ lại cho màn sau (chỉ ẩn đi)
     // Reset game state
     gameState = GameState::Playing;  // Thêm dòng này
     turn = 0;  // Thêm dòng này
@@ -318,55 +664,92 @@ void Game::cleanupForRestart()
     // KHÔNG destroy window và renderer - giữ lại để restart
     // KHÔNG gọi SDL_Quit(), TTF_Quit(), và không xóa g_audioInstance
 }
-void Game::run(char stage, SDL_Window *win)
+
+void Game::toggleSettings() {
+    // panel dựng sẵn trong buildPanels(): chỉ bật / tắt
+    settingsVisible = !settingsVisible && settingsPanel;
+}
+
+bool Game::screenToTile(float sx, float sy, int& tx, int& ty) const
 {
-    window = win;
-    init(stage);
-    while (isRunning)
-    {
-        handleEvents();
-        update();
-        render();
-        SDL_Delay(16); // ~60 FPS
+    if (!map || !renderer) return false;
+    float scaleX = 1.0f, scaleY = 1.0f;
+    SDL_GetRenderScale(renderer, &scaleX, &scaleY);
+    int tileSize = map->getTileSize();
+    float lx = sx / scaleX - static_cast<float>(offsetX);
+    float ly = sy / scaleY - static_cast<float>(offsetY);
+    if (lx < 0.0f || ly < 0.0f) return false;
+    tx = static_cast<int>(lx) / tileSize;
+    ty = static_cast<int>(ly) / tileSize;
+    return tx < map->getCols() && ty < map->getRows() && !map->isWall(tx, ty);
+}
+
+void Game::renderHoverPath(const Snapshot& s)
+{
+    if (gameState != GameState::Playing) return;
+
+    // đường đã được simulation tìm sẵn; các chấm đi chung một lệnh vẽ của LAYER_MARKERS
+    const int tileSize = map->getTileSize();
+    const float dot = tileSize * 0.25f;
+    for (const SDL_Point& p : s.hoverPath) {
+        drawList.fillRect(LAYER_MARKERS, { p.x * tileSize + offsetX + (tileSize - dot) * 0.5f,
+                                           p.y * tileSize + offsetY + (tileSize - dot) * 0.5f, dot, dot },
+                          { 255, 230, 120, 170 });
     }
-    cleanup();
 }
 
-void Game::toggleSettings() {
-    if (settingsVisible) {
-        settingsVisible = false;
-        if (settingsPanel) { 
-            settingsPanel->cleanup(); 
-            delete settingsPanel; 
-            settingsPanel = nullptr; 
+void Game::applyHotReload()
+{
+    std::vector<std::string> changed;
+    devWatcher.poll(changed);
+    if (changed.empty()) return;
+    stopSim(); // reloadMap đổi map/vị trí mà simulation đang đọc
+    for (const std::string& path : changed) {
+        Assets::forgetTexture(path); // lần acquire sau đọc lại file
+        if (path == mapPath) {
+            reloadMap();
+            continue;
         }
-        return;
+        bool used = false;
+        if (map) used = map->reloadTexture(path) || used;
+        if (background) used = background->reloadTexture(path) || used;
+        if (explorer) used = explorer->reloadTexture(path) || used;
+        if (mummy) used = mummy->reloadTexture(path) || used;
+        if (used) std::cerr << "Game::applyHotReload - reloaded " << path << "\n";
     }
-    settingsPanel = new SettingsPanel(renderer);
-    const int panelW = 1750, panelH = 900;
-    // Truyền isInGame = true và callback để thoát game
-    if (!settingsPanel->init(&user, panelW, panelH, 
-        [this]() {
-            // Callback cho RETURN: đóng panel và tiếp tục chơi
-            settingsVisible = false;
-            if (settingsPanel) { 
-                settingsPanel->cleanup(); 
-                delete settingsPanel; 
-                settingsPanel = nullptr; 
-            }
-        },
-        true, // isInGame = true
-        [this]() {
-            cleanup();
-            Start start;
-            start.run(window);
-        })) {
-        delete settingsPanel;
-        settingsPanel = nullptr;
-        return;
+    startSim();
+}
+
+void Game::reloadMap()
+{
+    if (!map || !explorer || !mummy) return;
+    map->loadFromFile(mapPath);
+    if (map->getRows() == 0) return; // file đang ghi dở; lần lưu sau sẽ báo lại
+
+    bitboard.build(map);
+    // hot reload chỉ chạy trong dev mode, nên kiểm tra luôn
+    if (!bitboard.verifyAgainst(map))
+        std::cerr << "Game::reloadMap - bitboard rules disagree with Map/Mummy rules\n";
+    pathCache.reset(&bitboard);
+    dangerOverlay.invalidate();
+    explorer->clearRoute();
+    hoverTileX = hoverTileY = -1;
+    map->getExitPosition(exitX, exitY);
+
+    int tileSize = map->getTileSize();
+    offsetX = (winW - tileSize * map->getCols()) * 95 / 100;
+    offsetY = (winH - tileSize * map->getRows()) / 2;
+
+    // giữ vị trí người chơi/mummy nếu ô đó vẫn đi được, nếu không thì về vị trí trong file
+    if (map->isWall(explorer->getX(), explorer->getY())) {
+        int x = 0, y = 0;
+        map->getExplorerPosition(x, y);
+        explorer->placeAt(x, y);
+    }
+    if (map->isWall(mummy->getX(), mummy->getY())) {
+        int x = 0, y = 0;
+        map->getMummyPosition(x, y);
+        mummy->placeAt(x, y);
     }
-    int px = (winW - panelW) / 2;
-    int py = (winH - panelH) / 2;
-    settingsPanel->setPosition(px, py);
-    settingsVisible = true;
-}
\ No newline at end of file
+    std::cerr << "Game::reloadMap - reloaded " << mapPath << "\n";
+}
@@ -4,52 +4,177 @@
 #include <SDL3_ttf/SDL_ttf.h>
 #include <iostream>
 #include <cstring>  
+#include <atomic>
+#include <thread>
 #include "ingame/map.h"
 #include "ingame/background.h"
 #include "ingame/panel.h"
+#include "ingame/bitboard.h"
+#include "ingame/overlay.h"
+#include "ingame/pathcache.h"
 #include "entities/explorer.h"
 #include "entities/mummy.h"
 #include "text.h"
 #include "functions.h"
 #include "user.h"
+#include "devwatch.h"
+#include "catalog.h"
+#include "drawlist.h"
+#include "scene.h"
+#include "simsync.h"
+#include "arena.h"
+#include "replay.h"
 
-class Game {
+// Level scene, pushed over the menu by Start and popped when the player quits to the
+// menu or finishes the last stage. Next level / retry reload inside the same scene.
+class Game : public Scene {
 private:
+    SceneManager* scenes = nullptr;
+    int startStage = 0;
     SDL_Window* window = nullptr;
     SDL_Renderer* renderer = nullptr;
     Background* background = nullptr;
-    bool isRunning = false;
     int turn = 0; // 0 = Explorer, 1 = Mummy
     int mummyStepsLeft = 0;
-    int winW = 1920;
-    int winH = 991;
-    float windowRatio = 1920.0/991.0;
+    int winW = SceneManager::LOGICAL_W;
+    int winH = SceneManager::LOGICAL_H;
     int offsetX = 0;
     int offsetY = 0;
+    int exitX = -1, exitY = -1;
+    std::string mapPath;
+    DevWatcher devWatcher; // MUMMYMAZE_DEV=1: hot reload of maps/textures
     User user;
-    char currentStage;
+    int currentStage = 0; // index into StageCatalog
     enum class GameState { Playing, Victory, Lost, TheEnd };
-    GameState gameState = GameState::Playing;
+    GameState gameState = GameState::Playing; // what the screen shows (main thread)
+
+    // ---- simulation / presentation ----
+    // simulate() owns explorer/mummy movement, turns, routes, hover path and the danger
+    // overlay; it takes input as SimCommands and publishes a Snapshot per tick.
+    // The main thread only draws the latest Snapshot and turns its phase into panels.
+    // With MUMMYMAZE_SIM_THREAD=1 simulate() runs on its own thread at SIM_HZ, so a slow
+    // frame (text/texture upload) never delays input or turn resolution; otherwise it
+    // runs inline once per frame. Level (re)loads and hot reload stop the thread first.
+    static const int SIM_HZ = 60;
+    struct SimCommand {
+        enum class Kind { Key, Click, Hover, ToggleDanger } kind = Kind::Key;
+        SDL_Event event{};    // Key
+        int tx = -1, ty = -1; // Click / Hover tile
+        Uint64 queuedNs = 0;
+    };
+    struct Snapshot {
+        uint64_t tick = 0;
+        GameState phase = GameState::Playing; // Victory = exit reached, Lost = caught
+        int turn = 0;
+        float explorerFx = 0.0f, explorerFy = 0.0f;
+        float mummyFx = 0.0f, mummyFy = 0.0f;
+        std::vector<SDL_Point> hoverPath;
+        DangerOverlay danger;
+        Uint64 publishedNs = 0;
+        // this run: explorer moves and play time (frozen when the phase leaves Playing)
+        int moves = 0;
+        Uint64 playNs = 0;
+        // simulation timing so far (this level)
+        uint64_t simTicks = 0;
+        double simAvgMs = 0.0, simMaxMs = 0.0;
+        double inputAvgMs = 0.0; // command queued -> applied
+    };
+    TripleBuffer<Snapshot> snapshots;
+    SpscQueue<SimCommand, 256> commands;
+    const Snapshot* frame = nullptr; // snapshot drawn this frame
+    bool useSimThread = false;
+    std::atomic<bool> simRunning{ false };
+    std::thread simThread;
+    GameState simPhase = GameState::Playing; // simulation side
+    int moveCount = 0;
+    Uint64 levelStartNs = 0, finishNs = 0;
+    uint64_t simTicks = 0;
+    double simTotalMs = 0.0, simMaxMs = 0.0;
+    double inputTotalMs = 0.0;
+    uint64_t inputCount = 0;
+    // presentation timing
+    uint64_t renderFrames = 0;
+    double renderTotalMs = 0.0, renderMaxMs = 0.0, ageTotalMs = 0.0;
+    int pendingStage = -1; // next level / retry asked for by a panel, loaded in update()
+
+    // with MUMMYMAZE_RECORD=1 each run is recorded (sim side, until the phase leaves Playing)
+    // and saved to replays/stage<id>.mmr; setPlayback() turns the scene into a player for
+    // one recording: input ignored, inline simulation, popped once it ends
+    bool recordRun = false; // fixed in init(), read by the sim
+    Replay recording;
+    Replay playback;
+    bool playingBack = false;
+    size_t playbackPos = 0; // next playback event
+    int playbackTail = 0;   // frames shown after the run ended
+    uint64_t shownBoardVersion = 0; // leaderboard state the victory panel shows
+
+    // background, map, in-game panel, explorer and mummy of the current stage (their own
+    // members still use the heap); releaseLevel() destroys them all with one reset
+    LevelArena levelArena;
 
     // Text hiển thị "THE END"
     Text theEndText;
 public:
     Map* map = nullptr;
+    Bitboard bitboard; // bit-parallel copy of map walls, rebuilt on every level load
+    DangerOverlay dangerOverlay; // toggled with D
+    PathCache pathCache;         // click-to-walk paths, reset on level load
+    DrawList drawList;           // map, overlay, path dots and characters, flushed once per frame (F3: stats)
+    int hoverTileX = -1, hoverTileY = -1;
+    std::vector<SDL_Point> hoverPath;
     Explorer* explorer = nullptr;
     Mummy* mummy = nullptr;
     // in-game UI panel on the right side
     IngamePanel* ingamePanel = nullptr;
+    // built once in enter() by buildPanels() and kept hidden across level reloads;
+    // showing one only re-binds its callback (see VictoryPanel::open)
     SettingsPanel* settingsPanel = nullptr;
     VictoryPanel* victoryPanel = nullptr;
     LostPanel* lostPanel = nullptr;
     bool settingsVisible = false;
 
-    void init(const char stage);
-    void handleEvents();
-    void update();
-    void render();
+    explicit Game(int stageIndex = 0) : startStage(stageIndex) {}
+    // play `replay` instead of taking input (before the scene is pushed)
+    void setPlayback(Replay replay);
+    static int simHz() { return SIM_HZ; }
+    ~Game() { stopSim(); }
+
+    bool enter(SceneManager* scenes) override;
+    void exit() override;
+    void handleEvents(const std::vector<SDL_Event>& events) override;
+    void update() override;
+    void render() override;
+
+    void init(int stageIndex);
     void cleanup();
     void cleanupForRestart();
-    void run(const char stage, SDL_Window* SDL_Window);
     void toggleSettings();
+private:
+    // window (event) coordinates -> map tile; false if outside the map
+    bool screenToTile(float sx, float sy, int& tx, int& ty) const;
+    void queueCommand(SimCommand cmd);
+    // one simulation tick: apply queued input, move, resolve turns, publish a Snapshot
+    void simulate();
+    void publishSnapshot();
+    void simLoop();
+    void startSim();
+    void stopSim();
+    // snapshot phase -> progress, victory/lost panels, THE END
+    void present();
+    // victory panel: the player's records and the level leaderboard, once merged by the store
+    void refreshVictoryBoard();
+    static bool recordEnabled(); // MUMMYMAZE_RECORD set and not "0"
+    // write this run's recording on a worker (recordRun only)
+    void saveRecording();
+    void resetTiming();
+    void reportTiming();
+    void renderTiming() const;
+    // dev mode: patch changed maps/textures into the running stage
+    void applyHotReload();
+    void reloadMap();
+    void renderHoverPath(const Snapshot& s);
+    // settings / victory / lost panels and THE END text, pre-built for the whole scene
+    bool buildPanels();
+    // end of a stage: stop the simulation and free everything in levelArena
+    void releaseLevel();
 };
\ No newline at end of file
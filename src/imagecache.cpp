@@ -0,0 +1,291 @@
+#include "imagecache.h"
+#include "assets.h"
+#include "devwatch.h"
+#include <SDL3_image/SDL_image.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+namespace {
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceStamp;
+    uint64_t sourceSize;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    uint32_t format;
+    uint64_t pixelHash;
+    uint8_t pad[16];
+};
+static_assert(sizeof(CacheHeader) == ImageCache::HEADER_SIZE, "image cache header must be 64 bytes");
+
+std::string g_dir = "cache";
+std::mutex g_writeLock; // workers may build entries concurrently
+
+// source bytes from the pack (borrowed) or the loose file (owned)
+struct Source {
+    const void* data = nullptr;
+    size_t size = 0;
+    void* owned = nullptr;
+    ~Source() { if (owned) SDL_free(owned); }
+};
+
+bool readSource(const std::string& path, Source& src)
+{
+    if (Assets::find(path, src.data, src.size)) return true;
+    src.owned = SDL_LoadFile(path.c_str(), &src.size);
+    src.data = src.owned;
+    return src.owned != nullptr;
+}
+
+// identity of the source without reading its bytes: the packer's content hash, or the
+// loose file's modification time (size is checked against the header as well)
+bool sourceStamp(const std::string& path, uint64_t& stamp, uint64_t& size)
+{
+    const void* data = nullptr;
+    size_t n = 0;
+    if (Assets::find(path, data, n, &stamp)) {
+        size = n;
+        return true;
+    }
+    SDL_PathInfo info;
+    if (!SDL_GetPathInfo(path.c_str(), &info) || info.type != SDL_PATHTYPE_FILE) return false;
+    size = info.size;
+    stamp = ImageCache::hashBytes(&info.modify_time, sizeof(info.modify_time));
+    return true;
+}
+
+// header + file size (+ pixel hash in dev mode); returns the pixel pointer inside the mapping or nullptr
+const uint8_t* validate(const MappedFile& file, uint64_t stamp, uint64_t srcSize, int w, int h,
+                        SDL_PixelFormat format, CacheHeader& hdr)
+{
+    if (file.size() < sizeof(CacheHeader)) return nullptr;
+    std::memcpy(&hdr, file.data(), sizeof(hdr));
+    if (std::memcmp(hdr.magic, "MMIC", 4) != 0 || hdr.version != ImageCache::VERSION) return nullptr;
+    if (hdr.sourceStamp != stamp || hdr.sourceSize != srcSize) return nullptr;
+    if (hdr.width != static_cast<uint32_t>(w) || hdr.height != static_cast<uint32_t>(h) ||
+        hdr.format != static_cast<uint32_t>(format) || hdr.pitch != static_cast<uint32_t>(w) * 4)
+        return nullptr;
+    const uint64_t bytes = static_cast<uint64_t>(hdr.pitch) * hdr.height;
+    if (file.size() != sizeof(CacheHeader) + bytes) return nullptr;
+    const uint8_t* pixels = file.data() + sizeof(CacheHeader);
+    // 4 bytes a pixel through the whole image: only where a stale file is worth the cost
+    if (DevWatcher::isDevMode() && ImageCache::hashBytes(pixels, static_cast<size_t>(bytes)) != hdr.pixelHash)
+        return nullptr;
+    return pixels;
+}
+}
+
+void ImageCache::setDirectory(const std::string& dir) { g_dir = dir; }
+
+SDL_PixelFormat ImageCache::preferredFormat(SDL_Renderer* renderer)
+{
+    const SDL_PixelFormat* formats = static_cast<const SDL_PixelFormat*>(
+        SDL_GetPointerProperty(SDL_GetRendererProperties(renderer), SDL_PROP_RENDERER_TEXTURE_FORMATS_POINTER, nullptr));
+    for (int i = 0; formats && formats[i] != SDL_PIXELFORMAT_UNKNOWN; ++i) {
+        if (SDL_BYTESPERPIXEL(formats[i]) == 4 && SDL_ISPIXELFORMAT_ALPHA(formats[i]) &&
+            !SDL_ISPIXELFORMAT_FOURCC(formats[i]) && !SDL_ISPIXELFORMAT_10BIT(formats[i]) &&
+            !SDL_ISPIXELFORMAT_FLOAT(formats[i]))
+            return formats[i];
+    }
+    return SDL_PIXELFORMAT_RGBA32;
+}
+
+uint64_t ImageCache::hashBytes(const void* data, size_t size)
+{
+    // FNV-1a over 8-byte words (then the tail); pack_assets computes dataHash the same way
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint64_t h = 1469598103934665603ull ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        h = (h ^ w) * 1099511628211ull;
+    }
+    for (; i < size; ++i) h = (h ^ p[i]) * 1099511628211ull;
+    return h;
+}
+
+SDL_Surface* ImageCache::boxScale(SDL_Surface* src, int w, int h)
+{
+    if (!src || w <= 0 || h <= 0) return nullptr;
+    SDL_Surface* in = (src->format == SDL_PIXELFORMAT_RGBA32) ? src : SDL_ConvertSurface(src, SDL_PIXELFORMAT_RGBA32);
+    if (!in) return nullptr;
+    SDL_Surface* out = SDL_CreateSurface(w, h, SDL_PIXELFORMAT_RGBA32);
+    if (!out) {
+        if (in != src) SDL_DestroySurface(in);
+        return nullptr;
+    }
+
+    const int sw = in->w, sh = in->h;
+    for (int y = 0; y < h; ++y) {
+        const int y0 = static_cast<int>(static_cast<int64_t>(y) * sh / h);
+        const int y1 = std::max(y0 + 1, static_cast<int>(static_cast<int64_t>(y + 1) * sh / h));
+        uint8_t* dstRow = static_cast<uint8_t*>(out->pixels) + static_cast<size_t>(out->pitch) * y;
+        for (int x = 0; x < w; ++x) {
+            const int x0 = static_cast<int>(static_cast<int64_t>(x) * sw / w);
+            const int x1 = std::max(x0 + 1, static_cast<int>(static_cast<int64_t>(x + 1) * sw / w));
+            // colour weighted by alpha so transparent pixels do not darken the edges
+            uint64_t r = 0, g = 0, b = 0, a = 0;
+            for (int sy = y0; sy < y1; ++sy) {
+                const uint8_t* p = static_cast<const uint8_t*>(in->pixels) + static_cast<size_t>(in->pitch) * sy + x0 * 4;
+                for (int sx = x0; sx < x1; ++sx, p += 4) {
+                    r += p[0] * p[3];
+                    g += p[1] * p[3];
+                    b += p[2] * p[3];
+                    a += p[3];
+                }
+            }
+            const uint64_t n = static_cast<uint64_t>(x1 - x0) * (y1 - y0);
+            uint8_t* d = dstRow + x * 4;
+            d[0] = a ? static_cast<uint8_t>(r / a) : 0;
+            d[1] = a ? static_cast<uint8_t>(g / a) : 0;
+            d[2] = a ? static_cast<uint8_t>(b / a) : 0;
+            d[3] = static_cast<uint8_t>(a / n);
+        }
+    }
+    if (in != src) SDL_DestroySurface(in);
+    return out;
+}
+
+std::string ImageCache::entryPath(const std::string& path, uint64_t stamp, int w, int h, SDL_PixelFormat format)
+{
+    char name[112];
+    std::snprintf(name, sizeof(name), "/%016llx_%016llx_%dx%d_%08x.img",
+                  static_cast<unsigned long long>(Assets::hashPath(path)), static_cast<unsigned long long>(stamp),
+                  w, h, static_cast<unsigned>(format));
+    return g_dir + name;
+}
+
+SDL_Surface* ImageCache::build(const std::string& path, const std::string& entry, int w, int h,
+                               SDL_PixelFormat format, uint64_t stamp)
+{
+    Source src;
+    if (!readSource(path, src)) return nullptr;
+    SDL_Surface* decoded = IMG_Load_IO(SDL_IOFromConstMem(src.data, src.size), true);
+    if (!decoded) {
+        std::cerr << "ImageCache - failed to decode " << path << " | " << SDL_GetError() << "\n";
+        return nullptr;
+    }
+    SDL_Surface* scaled = decoded;
+    if (decoded->w > w && decoded->h > h) scaled = boxScale(decoded, w, h);
+    else if (decoded->w != w || decoded->h != h) scaled = SDL_ScaleSurface(decoded, w, h, SDL_SCALEMODE_LINEAR);
+    SDL_Surface* out = scaled ? SDL_ConvertSurface(scaled, format) : nullptr;
+    if (scaled && scaled != decoded) SDL_DestroySurface(scaled);
+    SDL_DestroySurface(decoded);
+    if (!out) {
+        std::cerr << "ImageCache - failed to scale " << path << " | " << SDL_GetError() << "\n";
+        return nullptr;
+    }
+
+    // rows are written tightly packed so the file can be uploaded with pitch = w * 4
+    const size_t rowBytes = static_cast<size_t>(w) * 4;
+    std::string packed(rowBytes * h, '\0');
+    for (int y = 0; y < h; ++y)
+        std::memcpy(&packed[rowBytes * y], static_cast<const uint8_t*>(out->pixels) + static_cast<size_t>(out->pitch) * y, rowBytes);
+    const uint64_t pixelHash = hashBytes(packed.data(), packed.size());
+
+    CacheHeader hdr = {};
+    std::memcpy(hdr.magic, "MMIC", 4);
+    hdr.version = VERSION;
+    hdr.sourceStamp = stamp;
+    hdr.sourceSize = src.size;
+    hdr.width = static_cast<uint32_t>(w);
+    hdr.height = static_cast<uint32_t>(h);
+    hdr.pitch = static_cast<uint32_t>(rowBytes);
+    hdr.format = static_cast<uint32_t>(format);
+    hdr.pixelHash = pixelHash;
+
+    // write to a temp file and rename, so a crash never leaves a half entry behind
+    std::lock_guard<std::mutex> lk(g_writeLock);
+    SDL_CreateDirectory(g_dir.c_str());
+    const std::string tmp = entry + ".tmp";
+    {
+        std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+        if (ofs.is_open()) {
+            ofs.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+            ofs.write(packed.data(), static_cast<std::streamsize>(packed.size()));
+        }
+        if (!ofs.good()) {
+            std::cerr << "ImageCache - failed to write " << tmp << "\n";
+            ofs.close();
+            SDL_RemovePath(tmp.c_str());
+            return out;
+        }
+    }
+    if (!SDL_RenamePath(tmp.c_str(), entry.c_str())) {
+        std::cerr << "ImageCache - failed to store " << entry << " | " << SDL_GetError() << "\n";
+        SDL_RemovePath(tmp.c_str());
+        return out;
+    }
+
+    // entries of the same image, size and format under an older stamp are dead now
+    char pattern[80];
+    std::snprintf(pattern, sizeof(pattern), "%016llx_*_%dx%d_%08x.img",
+                  static_cast<unsigned long long>(Assets::hashPath(path)), w, h, static_cast<unsigned>(format));
+    const std::string own = entry.substr(g_dir.size() + 1);
+    int count = 0;
+    if (char** old = SDL_GlobDirectory(g_dir.c_str(), pattern, 0, &count)) {
+        for (int i = 0; i < count; ++i)
+            if (own != old[i]) SDL_RemovePath((g_dir + "/" + old[i]).c_str());
+        SDL_free(old);
+    }
+    return out;
+}
+
+SDL_Surface* ImageCache::loadSurface(const std::string& path, int w, int h, SDL_PixelFormat format)
+{
+    if (w <= 0 || h <= 0) return nullptr;
+    uint64_t stamp = 0, size = 0;
+    if (!sourceStamp(path, stamp, size)) return nullptr;
+    const std::string entry = entryPath(path, stamp, w, h, format);
+
+    MappedFile file;
+    CacheHeader hdr;
+    const uint8_t* pixels = file.open(entry) ? validate(file, stamp, size, w, h, format, hdr) : nullptr;
+    if (pixels) {
+        SDL_Surface* s = SDL_CreateSurface(w, h, format);
+        if (!s) return nullptr;
+        for (int y = 0; y < h; ++y)
+            std::memcpy(static_cast<uint8_t*>(s->pixels) + static_cast<size_t>(s->pitch) * y,
+                        pixels + static_cast<size_t>(hdr.pitch) * y, hdr.pitch);
+        return s;
+    }
+    file.close();
+    return build(path, entry, w, h, format, stamp);
+}
+
+SDL_Texture* ImageCache::loadTexture(SDL_Renderer* renderer, const std::string& path, int w, int h)
+{
+    if (!renderer || w <= 0 || h <= 0) return nullptr;
+    const SDL_PixelFormat format = preferredFormat(renderer);
+    uint64_t stamp = 0, size = 0;
+    if (!sourceStamp(path, stamp, size)) return nullptr;
+    const std::string entry = entryPath(path, stamp, w, h, format);
+
+    // hit: the source is never read, upload straight from the mapping
+    MappedFile file;
+    CacheHeader hdr;
+    const uint8_t* pixels = file.open(entry) ? validate(file, stamp, size, w, h, format, hdr) : nullptr;
+    if (pixels) {
+        SDL_Texture* tex = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STATIC, w, h);
+        if (tex && SDL_UpdateTexture(tex, nullptr, pixels, static_cast<int>(hdr.pitch))) {
+            SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+            return tex;
+        }
+        if (tex) SDL_DestroyTexture(tex);
+    }
+    file.close();
+
+    std::cerr << "ImageCache - rebuilding " << entry << " for " << path << "\n";
+    SDL_Surface* s = build(path, entry, w, h, format, stamp);
+    if (!s) return nullptr;
+    SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, s);
+    SDL_DestroySurface(s);
+    return tex;
+}
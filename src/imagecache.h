@@ -0,0 +1,50 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <string>
+
+// Persistent cache of decoded images already scaled to the size they are drawn at.
+// A miss decodes the source (pack or loose file), scales and converts it, and writes
+// one raw file per (path, source stamp, size, format) into the cache directory; a hit maps
+// that file and uploads the pixels as is, so no PNG inflate happens after the first run.
+// The source stamp is known without reading the source: the content hash the packer
+// stored in the pack toc, or the loose file's modification time. It is part of the file
+// name, so two packs (or an edited loose file) never fight over one entry; building an
+// entry removes the ones left by older stamps of the same image.
+//
+// Cache file layout (little endian, pixels start at HEADER_SIZE so they can be used
+// straight from the mapping):
+//   "MMIC", u32 version, u64 sourceStamp, u64 sourceSize,
+//   u32 width, u32 height, u32 pitch, u32 format, u64 pixelHash, zero padding
+// A hit checks the header and the file size only. pixelHash is written when the entry is
+// built and verified on hits in dev mode (MUMMYMAZE_DEV), where cache files are the
+// likelier to be stale or hand-edited.
+class ImageCache {
+public:
+    static const uint32_t VERSION = 3; // 2: box filter for downscales, 3: source stamp
+    static const uint32_t HEADER_SIZE = 64;
+
+    // where cache files go (created on demand), default "cache"
+    static void setDirectory(const std::string& dir);
+
+    // 32-bit format the renderer takes without conversion, RGBA32 if unsure
+    static SDL_PixelFormat preferredFormat(SDL_Renderer* renderer);
+
+    // `path` decoded and scaled to w x h; caller destroys the texture / surface.
+    // loadSurface touches no renderer state, so it is safe on JobPool workers.
+    static SDL_Texture* loadTexture(SDL_Renderer* renderer, const std::string& path, int w, int h);
+    static SDL_Surface* loadSurface(const std::string& path, int w, int h,
+                                    SDL_PixelFormat format = SDL_PIXELFORMAT_RGBA32);
+
+    static uint64_t hashBytes(const void* data, size_t size);
+
+    // area-average (box filter) downscale to w x h, alpha weighted; result is RGBA32.
+    // Used instead of bilinear whenever an image shrinks, so thumbnails do not alias.
+    static SDL_Surface* boxScale(SDL_Surface* src, int w, int h);
+
+private:
+    static std::string entryPath(const std::string& path, uint64_t stamp, int w, int h, SDL_PixelFormat format);
+    // decode `path` and write its entry; false-y (nullptr) only if decoding fails
+    static SDL_Surface* build(const std::string& path, const std::string& entry, int w, int h,
+                              SDL_PixelFormat format, uint64_t stamp);
+};
@@ -1,19 +1,24 @@
 #include "background.h"
+#include "../imagecache.h"
 #include <iostream>
 
 Background::Background(SDL_Renderer* renderer) : renderer(renderer) {}
 
 Background::~Background() { cleanup(); }
 
-bool Background::load(char stage)
+bool Background::load(const std::string& artPath)
 {
     if (!renderer) return false;
 
     cleanup(); // Xoá texture cũ nếu có
 
-    // Đường dẫn: assets/images/background/background{stage}.png
-    std::string path = "assets/images/background/background" + std::string(1, stage) + ".png";
-    texture = IMG_LoadTexture(renderer, path.c_str());
+    path = artPath;
+    // pre-scaled to the output size through the disk cache: no PNG decode after the first run
+    if (!SDL_GetCurrentRenderOutputSize(renderer, &outW, &outH) || outW <= 0 || outH <= 0) {
+        outW = 1920;
+        outH = 991;
+    }
+    texture = ImageCache::loadTexture(renderer, path, outW, outH);
     if (!texture) {
         std::cerr << "Failed to load background: " << path << " | " << SDL_GetError() << std::endl;
         return false;
@@ -21,6 +26,16 @@ bool Background::load(char stage)
     return true;
 }
 
+bool Background::reloadTexture(const std::string& changedPath)
+{
+    if (!renderer || changedPath != path) return false;
+    SDL_Texture* t = ImageCache::loadTexture(renderer, path, outW, outH); // source hash changed => rebuilt
+    if (!t) return false;
+    if (texture) SDL_DestroyTexture(texture);
+    texture = t;
+    return true;
+}
+
 void Background::render(int winW, int winH)
 {
     // no renderer or texture => nothing to draw
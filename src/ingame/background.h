@@ -7,13 +7,18 @@ class Background {
 private:
     SDL_Renderer* renderer = nullptr;
     SDL_Texture* texture = nullptr; // Chỉ 1 background duy nhất
+    std::string path;
+    int outW = 0, outH = 0; // size the cached pixels were scaled to
 
 public:
     Background(SDL_Renderer* renderer = nullptr);
     ~Background();
 
-    // load textures cho stage (background{stage}.png)
-    bool load(char stage);
+    // load background art của stage (StageInfo::art)
+    bool load(const std::string& artPath);
+
+    // re-decode if `changedPath` is the loaded background
+    bool reloadTexture(const std::string& changedPath);
 
     // render background (tĩnh)
     void render(int winW, int winH);
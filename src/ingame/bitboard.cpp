@@ -0,0 +1,354 @@
+#include "bitboard.h"
+#include "map.h"
+#include "../entities/mummy.h"
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define BITBOARD_SSE2 1
+#endif
+
+bool Bitboard::build(const Map* map)
+{
+    rows = 0;
+    cols = 0;
+    if (!map) return false;
+    int r = map->getRows();
+    int c = map->getCols();
+    if (r <= 0 || c <= 0) return false;
+    if (c > MAX_COLS) {
+        std::cerr << "Bitboard::build - map too wide (" << c << " cols, max " << MAX_COLS << ")\n";
+        return false;
+    }
+    rows = r;
+    cols = c;
+
+    open.assign(stride(), 0);
+    moveN.assign(stride(), 0);
+    moveE.assign(stride(), 0);
+    moveS.assign(stride(), 0);
+    moveW.assign(stride(), 0);
+
+    // move masks straight from the map's per-cell wall bits (tile or thin walls)
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            const uint64_t bit = 1ull << x;
+            if (!map->isWall(x, y)) open[y + 1] |= bit;
+            if (map->canStep(x, y, 0, -1)) moveN[y + 1] |= bit;
+            if (map->canStep(x, y, 1, 0))  moveE[y + 1] |= bit;
+            if (map->canStep(x, y, 0, 1))  moveS[y + 1] |= bit;
+            if (map->canStep(x, y, -1, 0)) moveW[y + 1] |= bit;
+        }
+    }
+    return true;
+}
+
+bool Bitboard::isOpen(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= cols || y >= rows) return false;
+    return (open[y + 1] >> x) & 1ull;
+}
+
+bool Bitboard::canStep(int x, int y, int dx, int dy) const
+{
+    if (x < 0 || y < 0 || x >= cols || y >= rows) return false;
+    const Cells* m = nullptr;
+    if (dx == 1 && dy == 0) m = &moveE;
+    else if (dx == -1 && dy == 0) m = &moveW;
+    else if (dx == 0 && dy == 1) m = &moveS;
+    else if (dx == 0 && dy == -1) m = &moveN;
+    else return false;
+    return ((*m)[y + 1] >> x) & 1ull;
+}
+
+Bitboard::Cells Bitboard::empty() const
+{
+    return Cells(stride(), 0);
+}
+
+Bitboard::Cells Bitboard::single(int x, int y) const
+{
+    Cells s = empty();
+    if (x >= 0 && y >= 0 && x < cols && y < rows) s[y + 1] = 1ull << x;
+    return s;
+}
+
+bool Bitboard::test(const Cells& s, int x, int y)
+{
+    if (x < 0 || y < 0 || x >= 64 || static_cast<size_t>(y + 1) >= s.size()) return false;
+    return (s[y + 1] >> x) & 1ull;
+}
+
+int Bitboard::count(const Cells& s)
+{
+    int n = 0;
+    for (uint64_t w : s) {
+        while (w) { w &= w - 1; ++n; }
+    }
+    return n;
+}
+
+bool Bitboard::intersects(const Cells& a, const Cells& b)
+{
+    const size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; ++i)
+        if (a[i] & b[i]) return true;
+    return false;
+}
+
+Bitboard::Cells Bitboard::expand(const Cells& from) const
+{
+    Cells out(stride(), 0);
+    const uint64_t* c = from.data();
+    uint64_t* o = out.data();
+    int p = 1;
+#ifdef BITBOARD_SSE2
+    // two rows per iteration; the padding rows make p+2 always readable
+    for (; p <= rows; p += 2) {
+        __m128i cur  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + p));
+        __m128i e    = _mm_and_si128(cur, _mm_loadu_si128(reinterpret_cast<const __m128i*>(moveE.data() + p)));
+        __m128i w    = _mm_and_si128(cur, _mm_loadu_si128(reinterpret_cast<const __m128i*>(moveW.data() + p)));
+        __m128i up   = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(c + p - 1)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(moveS.data() + p - 1)));
+        __m128i down = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(c + p + 1)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(moveN.data() + p + 1)));
+        __m128i res = _mm_or_si128(_mm_or_si128(cur, _mm_slli_epi64(e, 1)),
+                                   _mm_or_si128(_mm_srli_epi64(w, 1), _mm_or_si128(up, down)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o + p), res);
+    }
+#endif
+    for (; p <= rows; ++p) {
+        uint64_t cur = c[p];
+        o[p] = cur
+             | ((cur & moveE[p]) << 1)
+             | ((cur & moveW[p]) >> 1)
+             | (c[p - 1] & moveS[p - 1])
+             | (c[p + 1] & moveN[p + 1]);
+    }
+    return out;
+}
+
+Bitboard::Cells Bitboard::reachable(int x, int y) const
+{
+    Cells cur = single(x, y);
+    if (!isOpen(x, y)) return cur;
+    for (;;) {
+        Cells next = expand(cur);
+        if (next == cur) return cur;
+        cur.swap(next);
+    }
+}
+
+std::vector<Bitboard::Cells> Bitboard::distanceLayers(int x, int y, int maxSteps) const
+{
+    std::vector<Cells> layers;
+    if (!isOpen(x, y)) return layers;
+    Cells seen = single(x, y);
+    layers.push_back(seen);
+    while (maxSteps < 0 || static_cast<int>(layers.size()) <= maxSteps) {
+        Cells next = expand(layers.back());
+        bool any = false;
+        for (int p = 1; p <= rows; ++p) {
+            next[p] &= ~seen[p];
+            seen[p] |= next[p];
+            any = any || next[p] != 0;
+        }
+        if (!any) break;
+        layers.push_back(std::move(next));
+    }
+    return layers;
+}
+
+void Bitboard::distances(int x, int y, std::vector<int>& out) const
+{
+    out.assign(static_cast<size_t>(rows * cols), -1);
+    std::vector<Cells> layers = distanceLayers(x, y);
+    for (size_t d = 0; d < layers.size(); ++d) {
+        for (int r = 0; r < rows; ++r) {
+            uint64_t w = layers[d][r + 1];
+            while (w) {
+                int c = __builtin_ctzll(w);
+                out[r * cols + c] = static_cast<int>(d);
+                w &= w - 1;
+            }
+        }
+    }
+}
+
+Bitboard::Cells Bitboard::mummyReach(int mx, int my, int turns) const
+{
+    Cells cur = single(mx, my);
+    for (int i = 0; i < turns * 2; ++i) {
+        Cells next = expand(cur);
+        if (next == cur) break;
+        cur.swap(next);
+    }
+    return cur;
+}
+
+void Bitboard::mummyStep(int x, int y, int targetX, int targetY, int& nx, int& ny) const
+{
+    int dx = targetX - x;
+    int dy = targetY - y;
+    int sx = (dx > 0) ? 1 : -1;
+    int sy = (dy > 0) ? 1 : -1;
+
+    // same priority order as Mummy::nextStep
+    int dirs[4][2];
+    if (std::abs(dx) > std::abs(dy)) {
+        dirs[0][0] = sx; dirs[0][1] = 0;
+        dirs[1][0] = 0;  dirs[1][1] = sy;
+        dirs[2][0] = 0;  dirs[2][1] = -sy;
+        dirs[3][0] = -sx; dirs[3][1] = 0;
+    } else {
+        dirs[0][0] = 0;  dirs[0][1] = sy;
+        dirs[1][0] = sx; dirs[1][1] = 0;
+        dirs[2][0] = -sx; dirs[2][1] = 0;
+        dirs[3][0] = 0;  dirs[3][1] = -sy;
+    }
+
+    nx = x;
+    ny = y;
+    for (int i = 0; i < 4; ++i) {
+        if (canStep(x, y, dirs[i][0], dirs[i][1])) {
+            nx = x + dirs[i][0];
+            ny = y + dirs[i][1];
+            return;
+        }
+    }
+}
+
+bool Bitboard::verifyAgainst(const Map* map) const
+{
+    if (!map || map->getRows() != rows || map->getCols() != cols) {
+        std::cerr << "Bitboard::verifyAgainst - size mismatch\n";
+        return false;
+    }
+
+    // 1. walls and move masks
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            if (isOpen(x, y) == map->isWall(x, y)) {
+                std::cerr << "Bitboard::verifyAgainst - wall mismatch at (" << x << "," << y << ")\n";
+                return false;
+            }
+            const int d4[4][2] = { {0,-1}, {1,0}, {0,1}, {-1,0} };
+            for (const auto& d : d4) {
+                if (canStep(x, y, d[0], d[1]) != map->canStep(x, y, d[0], d[1])) {
+                    std::cerr << "Bitboard::verifyAgainst - move mismatch at (" << x << "," << y << ")\n";
+                    return false;
+                }
+            }
+        }
+    }
+
+    // 2. mummy rule, every open mummy cell against every open target
+    for (int my = 0; my < rows; ++my) {
+        for (int mx = 0; mx < cols; ++mx) {
+            if (!isOpen(mx, my)) continue;
+            for (int ty = 0; ty < rows; ++ty) {
+                for (int tx = 0; tx < cols; ++tx) {
+                    if (!isOpen(tx, ty)) continue;
+                    int ax = 0, ay = 0, bx = 0, by = 0;
+                    Mummy::nextStep(map, mx, my, tx, ty, ax, ay);
+                    mummyStep(mx, my, tx, ty, bx, by);
+                    if (ax != bx || ay != by) {
+                        std::cerr << "Bitboard::verifyAgainst - mummy step mismatch from (" << mx << "," << my
+                                  << ") to (" << tx << "," << ty << "): map=(" << ax << "," << ay
+                                  << ") bitboard=(" << bx << "," << by << ")\n";
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    // 3. flood fill against a plain cell-by-cell BFS
+    for (int sy = 0; sy < rows; ++sy) {
+        for (int sx = 0; sx < cols; ++sx) {
+            if (!isOpen(sx, sy)) continue;
+            std::vector<int> bits;
+            distances(sx, sy, bits);
+
+            std::vector<int> ref(static_cast<size_t>(rows * cols), -1);
+            std::vector<int> queue;
+            ref[sy * cols + sx] = 0;
+            queue.push_back(sy * cols + sx);
+            for (size_t i = 0; i < queue.size(); ++i) {
+                int cx = queue[i] % cols, cy = queue[i] / cols;
+                const int d4[4][2] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
+                for (const auto& d : d4) {
+                    int nx = cx + d[0], ny = cy + d[1];
+                    if (!map->canStep(cx, cy, d[0], d[1]) || ref[ny * cols + nx] >= 0) continue;
+                    ref[ny * cols + nx] = ref[queue[i]] + 1;
+                    queue.push_back(ny * cols + nx);
+                }
+            }
+            if (bits != ref) {
+                std::cerr << "Bitboard::verifyAgainst - distance mismatch from (" << sx << "," << sy << ")\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Bitboard::benchmarkAgainst(const Map* map) const
+{
+    if (!map || map->getRows() != rows || map->getCols() != cols) return;
+    std::vector<SDL_Point> starts;
+    for (int y = 0; y < rows; ++y)
+        for (int x = 0; x < cols; ++x)
+            if (isOpen(x, y)) starts.push_back({ x, y });
+    if (starts.empty()) return;
+
+    // each side repeats full passes (one fill per open cell) for at least BENCH_NS
+    const Uint64 BENCH_NS = 20 * 1000000ull;
+    int sink = 0; // keeps the fills from being optimized away
+
+    uint64_t bitFills = 0;
+    const Uint64 bitStart = SDL_GetTicksNS();
+    Uint64 bitNs = 0;
+    do {
+        for (const SDL_Point& p : starts) sink += count(reachable(p.x, p.y));
+        bitFills += starts.size();
+        bitNs = SDL_GetTicksNS() - bitStart;
+    } while (bitNs < BENCH_NS);
+
+    uint64_t cellFills = 0;
+    std::vector<uint8_t> seen(static_cast<size_t>(rows * cols));
+    std::vector<int> queue;
+    queue.reserve(seen.size());
+    const Uint64 cellStart = SDL_GetTicksNS();
+    Uint64 cellNs = 0;
+    do {
+        for (const SDL_Point& p : starts) {
+            std::fill(seen.begin(), seen.end(), 0);
+            queue.clear();
+            seen[p.y * cols + p.x] = 1;
+            queue.push_back(p.y * cols + p.x);
+            for (size_t i = 0; i < queue.size(); ++i) {
+                const int cx = queue[i] % cols, cy = queue[i] / cols;
+                const int d4[4][2] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
+                for (const auto& d : d4) {
+                    const int n = (cy + d[1]) * cols + cx + d[0];
+                    if (!map->canStep(cx, cy, d[0], d[1]) || seen[n]) continue;
+                    seen[n] = 1;
+                    queue.push_back(n);
+                }
+            }
+            sink += static_cast<int>(queue.size());
+        }
+        cellFills += starts.size();
+        cellNs = SDL_GetTicksNS() - cellStart;
+    } while (cellNs < BENCH_NS);
+
+    const double bitRate = bitFills * 1e9 / bitNs;
+    const double cellRate = cellFills * 1e9 / cellNs;
+    std::cerr << "Bitboard::benchmarkAgainst - " << cols << "x" << rows << " reachability: bitboard "
+              << bitRate << " fills/s, cell-by-cell " << cellRate << " fills/s (x" << bitRate / cellRate
+              << ", check " << (sink & 1) << ")\n";
+}
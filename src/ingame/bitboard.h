@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+class Map;
+
+// Bit-parallel rules/analysis view of a Map.
+// One 64-bit word per row, bit c = column c. Legal moves are stored as four
+// direction masks so a whole flood-fill step is a handful of shifts and ANDs
+// per row instead of a Map::canStep call per cell.
+class Bitboard {
+public:
+    static const int MAX_COLS = 64;
+
+    // a set of cells; rows are padded (see build) so use Bitboard helpers to index it
+    using Cells = std::vector<uint64_t>;
+
+    // rebuild from the map's current walls. Returns false if the map is empty or too wide.
+    bool build(const Map* map);
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+
+    bool isOpen(int x, int y) const;
+    bool canStep(int x, int y, int dx, int dy) const;
+
+    // cell set helpers
+    Cells empty() const;
+    Cells single(int x, int y) const;
+    static bool test(const Cells& s, int x, int y);
+    static int count(const Cells& s);
+    static bool intersects(const Cells& a, const Cells& b);
+
+    // one step in every legal direction (the start cells are kept)
+    Cells expand(const Cells& from) const;
+
+    // every cell reachable from (x,y)
+    Cells reachable(int x, int y) const;
+
+    // layers[d] = cells at exactly d steps from (x,y); stops when nothing new is found or at maxSteps
+    std::vector<Cells> distanceLayers(int x, int y, int maxSteps = -1) const;
+
+    // per-cell step distance (index y*cols+x), -1 = unreachable
+    void distances(int x, int y, std::vector<int>& out) const;
+
+    // tiles the mummy could stand on after at most `turns` turns (2 steps per turn)
+    Cells mummyReach(int mx, int my, int turns) const;
+
+    // same decision as Mummy::nextStep, using the move masks
+    void mummyStep(int x, int y, int targetX, int targetY, int& nx, int& ny) const;
+
+    // cross-check against Map::isWall/canStep and Mummy::nextStep; logs the first mismatch.
+    // O(cells^2) (mummy rule for every pair): dev mode only
+    bool verifyAgainst(const Map* map) const;
+    // time reachable() from every open cell against a cell-by-cell BFS over Map::canStep
+    // and log both rates (dev mode, next to verifyAgainst)
+    void benchmarkAgainst(const Map* map) const;
+
+private:
+    int rows = 0;
+    int cols = 0;
+    // storage is rows + 3 words: one zero row above, two below, so the
+    // vertical neighbours of any row (and SIMD row pairs) can be read without bounds checks
+    Cells open;
+    Cells moveN, moveE, moveS, moveW; // bit set => a step from that cell in that direction is legal
+
+    int stride() const { return rows + 3; }
+};
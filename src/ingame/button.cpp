@@ -1,11 +1,12 @@
 #include "button.h"
+#include "../assets.h"
 #include <iostream>
 
 Button::Button(SDL_Renderer* renderer) : renderer(renderer) {}
 Button::~Button() { cleanup(); }
 
 SDL_Texture* Button::loadTexture(const std::string& path) {
-    SDL_Texture* tex = IMG_LoadTexture(renderer, path.c_str());
+    SDL_Texture* tex = Assets::acquireTexture(renderer, path); // mọi nút dùng chung 2 skin
     if (!tex)
         std::cerr << "Failed to load: " << path << " | " << SDL_GetError() << std::endl;
     return tex;
@@ -17,6 +18,7 @@ bool Button::create(SDL_Renderer* rend,
                     SDL_Color textColor, const std::string& fontPath)
 {
     cleanup();
+    ++version;
     renderer = rend;
     if (!renderer) { std::cerr << "Button::create - no renderer\n"; return false; }
 
@@ -118,6 +120,7 @@ void Button::handleEvent(const SDL_Event& e)
 
     bool inside = (mx >= rect.x && mx < rect.x + rect.w && my >= rect.y && my < rect.y + rect.h);
 
+    const bool wasClicked = clicked;
     if (e.type == SDL_EVENT_MOUSE_BUTTON_DOWN && e.button.button == SDL_BUTTON_LEFT) {
         clicked = inside;
         std::cerr << "Button::handleEvent - MOUSE_DOWN inside=" << inside << " rect=("
@@ -140,6 +143,7 @@ void Button::handleEvent(const SDL_Event& e)
         }
         clicked = false;
     }
+    if (clicked != wasClicked) ++version;
 }
 
 void Button::render()
@@ -182,8 +186,8 @@ void Button::setLabelWrapWidth(int w)
 
 void Button::cleanup()
 {
-    if (texNormal) { SDL_DestroyTexture(texNormal); texNormal = nullptr; }
-    if (texOnClick)  { SDL_DestroyTexture(texOnClick);  texOnClick = nullptr; }
+    if (texNormal) { Assets::releaseTexture(texNormal); texNormal = nullptr; }
+    if (texOnClick)  { Assets::releaseTexture(texOnClick);  texOnClick = nullptr; }
     if (label) { label->cleanup(); label.reset(); }
 }
 
@@ -198,6 +202,7 @@ void Button::setPosition(int x, int y)
 
 void Button::setSize(int w, int h)
 {
+    if (w != rect.w || h != rect.h) ++version;
     rect.w = w;
     rect.h = h;
     if (label) {
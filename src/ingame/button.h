@@ -13,6 +13,7 @@ private:
     SDL_Texture* texOnClick = nullptr;
     SDL_Rect rect{0,0,0,0};
     bool clicked = false;
+    uint32_t version = 0; // bumped on any change of how the button looks
 
     std::unique_ptr<Text> label;
     std::function<void()> onClick;
@@ -58,6 +59,9 @@ public:
     void handleEvent(const SDL_Event& e);
     void render();
 
+    // changes whenever the button would render differently (pressed state, size, label)
+    uint32_t getVersion() const { return version + (label ? label->getVersion() : 0); }
+
     // callback
     void setCallback(std::function<void()> cb);
 
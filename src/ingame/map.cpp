@@ -1,63 +1,192 @@
 #include "map.h"
-#include <fstream>
+#include "../assets.h"
+#include <sstream>
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 
 SDL_Texture* Map::loadTexture(const std::string& path) {
-    SDL_Texture* tex = IMG_LoadTexture(renderer, path.c_str());
+    SDL_Texture* tex = Assets::acquireTexture(renderer, path);
     if (!tex)
         std::cerr << "Failed to load: " << path << " | " << SDL_GetError() << std::endl;
     return tex;
 }
 
-Map::Map(SDL_Renderer* ren, char stage) : renderer(ren) {
-    tex_floor_light = loadTexture("assets/images/grid/lightGrid" + std::string(1, stage) + ".png");
-    tex_floor_dark  = loadTexture("assets/images/grid/darkGrid" + std::string(1, stage) + ".png");
-    tex_wall        = loadTexture("assets/images/wall/wall" + std::string(1, stage) + ".png");
-    tex_exit        = loadTexture("assets/images/grid/exit1.jpg");
+Map::Map(SDL_Renderer* ren, const std::string& theme) : renderer(ren) {
+    texPaths[0] = "assets/images/grid/lightGrid" + theme + ".png";
+    texPaths[1] = "assets/images/grid/darkGrid" + theme + ".png";
+    texPaths[2] = "assets/images/wall/wall" + theme + ".png";
+    texPaths[3] = "assets/images/grid/exit1.jpg";
+    tex_floor_light = loadTexture(texPaths[0]);
+    tex_floor_dark  = loadTexture(texPaths[1]);
+    tex_wall        = loadTexture(texPaths[2]);
+    tex_exit        = loadTexture(texPaths[3]);
+}
+
+bool Map::reloadTexture(const std::string& path) {
+    SDL_Texture** slots[4] = { &tex_floor_light, &tex_floor_dark, &tex_wall, &tex_exit };
+    for (int i = 0; i < 4; ++i) {
+        if (texPaths[i] != path) continue;
+        SDL_Texture* tex = loadTexture(path);
+        if (!tex) return false; // giữ texture cũ nếu file đang ghi dở
+        Assets::releaseTexture(*slots[i]);
+        *slots[i] = tex;
+        return true;
+    }
+    return false;
 }
 
 Map::~Map() {
-    SDL_DestroyTexture(tex_floor_light);
-    SDL_DestroyTexture(tex_floor_dark);
-    SDL_DestroyTexture(tex_wall);
-    SDL_DestroyTexture(tex_exit);
+    Assets::releaseTexture(tex_floor_light);
+    Assets::releaseTexture(tex_floor_dark);
+    Assets::releaseTexture(tex_wall);
+    Assets::releaseTexture(tex_exit);
 }
 
 void Map::loadFromFile(const std::string& path) {
-    std::ifstream f(path);
-    if (!f.is_open()) {
+    std::string text;
+    if (!Assets::loadText(path, text)) {
         std::cerr << "Error: Could not open map file: " << path << std::endl;
         return;
     }
+    std::istringstream f(text);
 
     grid.clear();
-    int val;
-    std::vector<int> row;
-    while (f >> val) {
-        row.push_back(val);
-        if (row.size() == 15) { 
-            grid.push_back(row);
-            row.clear();
+    walls.clear();
+    edgeWalls = false;
+
+    std::vector<uint8_t> edgeMasks;
+    std::string line;
+    bool first = true;
+    while (std::getline(f, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        if (first) {
+            first = false;
+            if (line.rfind("#edges", 0) == 0) {
+                edgeWalls = true;
+                continue;
+            }
+        }
+
+        std::vector<int> row;
+        if (edgeWalls) {
+            if (!parseEdgeRow(line, row, edgeMasks)) {
+                std::cerr << "Error: bad thin-wall row in " << path << ": " << line << std::endl;
+                grid.clear();
+                return;
+            }
+        } else {
+            std::istringstream iss(line);
+            int val;
+            while (iss >> val) row.push_back(val);
+        }
+        grid.push_back(std::move(row));
+    }
+
+    // các hàng phải cùng độ rộng; hàng thiếu được bù bằng tường
+    size_t cols = 0;
+    for (const auto& row : grid) cols = std::max(cols, row.size());
+    for (size_t r = 0; r < grid.size(); ++r) {
+        if (grid[r].size() == cols) continue;
+        std::cerr << "Warning: map row " << r << " in " << path << " has " << grid[r].size()
+                  << " cells, expected " << cols << std::endl;
+        if (edgeWalls)
+            edgeMasks.insert(edgeMasks.begin() + static_cast<long>(r * cols + grid[r].size()),
+                             cols - grid[r].size(), 0xF);
+        grid[r].resize(cols, edgeWalls ? 0 : 1);
+    }
+
+    if (edgeWalls) walls = std::move(edgeMasks);
+    buildWallMasks();
+}
+
+bool Map::parseEdgeRow(const std::string& line, std::vector<int>& row, std::vector<uint8_t>& masks) {
+    std::istringstream iss(line);
+    std::string tok;
+    while (iss >> tok) {
+        char h = static_cast<char>(std::toupper(static_cast<unsigned char>(tok[0])));
+        int mask = (h >= '0' && h <= '9') ? h - '0' : (h >= 'A' && h <= 'F') ? h - 'A' + 10 : -1;
+        if (mask < 0 || tok.size() > 2) return false;
+        int code = 0;
+        if (tok.size() == 2) {
+            switch (std::toupper(static_cast<unsigned char>(tok[1]))) {
+                case 'M': code = 2; break;
+                case 'E': code = 3; break;
+                case 'X': code = 4; break;
+                default: return false;
+            }
+        }
+        row.push_back(code);
+        masks.push_back(static_cast<uint8_t>(mask));
+    }
+    return !row.empty();
+}
+
+void Map::buildWallMasks() {
+    const int rows = getRows();
+    const int cols = getCols();
+    if (!edgeWalls) walls.assign(static_cast<size_t>(rows * cols), 0);
+
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            uint8_t& m = walls[y * cols + x];
+            if (!edgeWalls) {
+                // tường kiểu ô: ô tường đóng cả 4 phía, ô cạnh tường đóng phía giáp tường
+                if (grid[y][x] == 1) { m = 0xF; continue; }
+                if (isWall(x, y - 1)) m |= WALL_N;
+                if (isWall(x + 1, y)) m |= WALL_E;
+                if (isWall(x, y + 1)) m |= WALL_S;
+                if (isWall(x - 1, y)) m |= WALL_W;
+            } else {
+                // tường mỏng: mỗi cạnh chung chỉ cần ghi ở một phía, đồng bộ sang ô bên kia
+                if (y == 0) m |= WALL_N;
+                if (x == cols - 1) m |= WALL_E;
+                if (y == rows - 1) m |= WALL_S;
+                if (x == 0) m |= WALL_W;
+                if ((m & WALL_E) && x + 1 < cols) walls[y * cols + x + 1] |= WALL_W;
+                if ((m & WALL_S) && y + 1 < rows) walls[(y + 1) * cols + x] |= WALL_N;
+                if ((m & WALL_W) && x > 0) walls[y * cols + x - 1] |= WALL_E;
+                if ((m & WALL_N) && y > 0) walls[(y - 1) * cols + x] |= WALL_S;
+            }
         }
     }
-    f.close();
 }
 
-void Map::render(int offsetX, int offsetY) {
+void Map::render(DrawList& list, int offsetX, int offsetY) {
     for (size_t r = 0; r < grid.size(); ++r) {
         for (size_t c = 0; c < grid[r].size(); ++c) {
             SDL_FRect rect = { (float)(c * TILE_SIZE + offsetX), (float)(r * TILE_SIZE + offsetY),
                                 (float)TILE_SIZE, (float)TILE_SIZE };
 
             if ((r + c) % 2 == 0)
-                SDL_RenderTexture(renderer, tex_floor_light, NULL, &rect);
+                list.sprite(LAYER_FLOOR, tex_floor_light, rect);
             else
-                SDL_RenderTexture(renderer, tex_floor_dark, NULL, &rect);
+                list.sprite(LAYER_FLOOR, tex_floor_dark, rect);
 
             if (grid[r][c] == 1)
-                SDL_RenderTexture(renderer, tex_wall, NULL, &rect);
+                list.sprite(LAYER_WALLS, tex_wall, rect);
             if (grid[r][c] == 4)
-                SDL_RenderTexture(renderer, tex_exit, NULL, &rect);
+                list.sprite(LAYER_WALLS, tex_exit, rect);
+        }
+    }
+    if (edgeWalls) renderEdgeWalls(list, offsetX, offsetY);
+}
+
+void Map::renderEdgeWalls(DrawList& list, int offsetX, int offsetY) {
+    const int rows = getRows();
+    const int cols = getCols();
+    const float t = TILE_SIZE / 8.0f;
+    const float len = TILE_SIZE + t;
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            uint8_t m = walls[y * cols + x];
+            float left = (float)(x * TILE_SIZE + offsetX) - t * 0.5f;
+            float top  = (float)(y * TILE_SIZE + offsetY) - t * 0.5f;
+            // mỗi cạnh vẽ một lần: cạnh N/W của mọi ô, cạnh E/S chỉ ở viền
+            if (m & WALL_N) list.sprite(LAYER_WALLS, tex_wall, { left, top, len, t });
+            if (m & WALL_W) list.sprite(LAYER_WALLS, tex_wall, { left, top, t, len });
+            if ((m & WALL_E) && x == cols - 1) list.sprite(LAYER_WALLS, tex_wall, { left + TILE_SIZE, top, t, len });
+            if ((m & WALL_S) && y == rows - 1) list.sprite(LAYER_WALLS, tex_wall, { left, top + TILE_SIZE, len, t });
         }
     }
 }
@@ -68,6 +197,22 @@ bool Map::isWall(int x, int y) const {
     return grid[y][x] == 1;
 }
 
+bool Map::canStep(int x, int y, int dx, int dy) const {
+    uint8_t bit;
+    if (dx == 0 && dy == -1) bit = WALL_N;
+    else if (dx == 1 && dy == 0) bit = WALL_E;
+    else if (dx == 0 && dy == 1) bit = WALL_S;
+    else if (dx == -1 && dy == 0) bit = WALL_W;
+    else return false;
+    return !(getWalls(x, y) & bit);
+}
+
+uint8_t Map::getWalls(int x, int y) const {
+    const int cols = getCols();
+    if (y < 0 || y >= getRows() || x < 0 || x >= cols) return 0xF;
+    return walls[y * cols + x];
+}
+
 bool Map::isExit(int x, int y) const {
     if (y < 0 || y >= (int)grid.size()) return false;
     if (x < 0 || x >= (int)grid[y].size()) return false;
@@ -1,8 +1,17 @@
 #pragma once
 #include <SDL3/SDL.h>
 #include <SDL3_image/SDL_image.h>
+#include <cstdint>
 #include <vector>
 #include <string>
+#include "../drawlist.h"
+
+// Level files come in two layouts:
+//  - tile walls (original): one row per line, 0 floor, 1 wall, 2 mummy, 3 explorer, 4 exit
+//  - thin walls: first line "#edges", then one row per line where every cell is a hex
+//    N/E/S/W wall mask (1/2/4/8) optionally followed by M (mummy), E (explorer) or X (exit),
+//    e.g. "9 1 3X". Shared edges only need to be written on one side.
+// Either way every cell ends up with a wall mask, so a move check is one bit test.
 
 class Map {
 private:
@@ -11,19 +20,34 @@ private:
     SDL_Texture* tex_floor_dark;
     SDL_Texture* tex_wall;
     SDL_Texture* tex_exit;
+    std::string texPaths[4]; // floor light, floor dark, wall, exit (for hot reload)
     
     std::vector<std::vector<int>> grid;
+    std::vector<uint8_t> walls; // per-cell N/E/S/W mask, row-major
+    bool edgeWalls = false;     // level uses the thin-wall layout
     int TILE_SIZE = 64;
 
     SDL_Texture* loadTexture(const std::string& path);
+    bool parseEdgeRow(const std::string& line, std::vector<int>& row, std::vector<uint8_t>& masks);
+    void buildWallMasks();
+    void renderEdgeWalls(DrawList& list, int offsetX, int offsetY);
 
 public:
-    Map(SDL_Renderer* ren, char stage);
+    Map(SDL_Renderer* ren, const std::string& theme);
     ~Map();
 
     void loadFromFile(const std::string& path);
-    void render(int offsetX, int offsetY);
+    // re-decode one of this map's textures if `path` is one of them
+    bool reloadTexture(const std::string& path);
+    // floor on LAYER_FLOOR, walls/exit on LAYER_WALLS: one geometry call per texture
+    void render(DrawList& list, int offsetX, int offsetY);
+    static constexpr uint8_t WALL_N = 1, WALL_E = 2, WALL_S = 4, WALL_W = 8;
+
     bool isWall(int x, int y) const;
+    // can something standing on (x,y) step by (dx,dy)? (dx,dy) must be one of the 4 unit steps
+    bool canStep(int x, int y, int dx, int dy) const;
+    uint8_t getWalls(int x, int y) const;
+    bool hasEdgeWalls() const { return edgeWalls; }
     int getCols() const;
     int getRows() const;
     int getTileSize() const { return TILE_SIZE; }
@@ -0,0 +1,102 @@
+#include "overlay.h"
+
+static const int DIRS[4][2] = { {0,-1}, {1,0}, {0,1}, {-1,0} };
+
+void DangerOverlay::invalidate()
+{
+    lastEx = lastEy = lastMx = lastMy = -1;
+    tiles.clear();
+}
+
+bool DangerOverlay::caughtThisTurn(const Bitboard& board, int ex, int ey, int& mx, int& my)
+{
+    if (mx == ex && my == ey) return true;
+    for (int step = 0; step < 2; ++step) {
+        int nx = mx, ny = my;
+        board.mummyStep(mx, my, ex, ey, nx, ny);
+        mx = nx;
+        my = ny;
+        if (mx == ex && my == ey) return true;
+    }
+    return false;
+}
+
+bool DangerOverlay::canMeet(const Bitboard& board, int ex, int ey, int mx, int my, int turns)
+{
+    // the explorer takes one step a turn, the mummy two: a capture needs a shared tile
+    const Bitboard::Cells reach = board.mummyReach(mx, my, turns);
+    for (const Bitboard::Cells& layer : board.distanceLayers(ex, ey, turns))
+        if (Bitboard::intersects(reach, layer)) return true;
+    return false;
+}
+
+bool DangerOverlay::forcedCapture(const Bitboard& board, int ex, int ey, int mx, int my, int turns) const
+{
+    if (turns <= 0) return false;
+    // depth-first over turns with an explicit stack, one frame per turn (never more than
+    // `turns`). A line the explorer survives makes every turn above it safe as well, so the
+    // first one found answers the whole question; a frame whose moves are all caught is doomed
+    // and its parent goes on with its next move
+    struct Frame {
+        int ex, ey, mx, my;
+        int dir;      // next direction to try
+        bool anyMove;
+    };
+    std::vector<Frame> stack;
+    stack.reserve(turns);
+    stack.push_back({ ex, ey, mx, my, 0, false });
+    while (!stack.empty()) {
+        Frame& f = stack.back();
+        bool descended = false;
+        while (f.dir < 4 && !descended) {
+            const int dx = DIRS[f.dir][0], dy = DIRS[f.dir][1];
+            ++f.dir;
+            if (!board.canStep(f.ex, f.ey, dx, dy)) continue;
+            f.anyMove = true;
+            const int nx = f.ex + dx, ny = f.ey + dy;
+            if (nx == exitX && ny == exitY) return false; // reaching the exit wins before the mummy moves
+            int mx2 = f.mx, my2 = f.my;
+            if (caughtThisTurn(board, nx, ny, mx2, my2)) continue;
+            if (static_cast<int>(stack.size()) == turns) return false; // survived the look-ahead
+            stack.push_back({ nx, ny, mx2, my2, 0, false }); // within the reserve: f stays valid
+            descended = true;
+        }
+        if (descended) continue;
+        if (!f.anyMove) return false; // stuck, but not caught
+        stack.pop_back();             // doomed
+    }
+    return true;
+}
+
+void DangerOverlay::update(const Bitboard& board, int ex, int ey, int mx, int my, int exX, int exY)
+{
+    if (ex == lastEx && ey == lastEy && mx == lastMx && my == lastMy) return;
+    lastEx = ex; lastEy = ey; lastMx = mx; lastMy = my;
+    exitX = exX; exitY = exY;
+
+    tiles.clear();
+    for (const auto& d : DIRS) {
+        if (!board.canStep(ex, ey, d[0], d[1])) continue;
+        int nx = ex + d[0], ny = ey + d[1];
+        if (nx == exitX && ny == exitY) continue;
+        int mx2 = mx, my2 = my;
+        if (caughtThisTurn(board, nx, ny, mx2, my2))
+            tiles.push_back({ nx, ny, Danger::Caught });
+        else if (LOOKAHEAD_TURNS > 1 && canMeet(board, nx, ny, mx2, my2, LOOKAHEAD_TURNS - 1) &&
+                 forcedCapture(board, nx, ny, mx2, my2, LOOKAHEAD_TURNS - 1))
+            tiles.push_back({ nx, ny, Danger::Doomed });
+    }
+}
+
+void DangerOverlay::render(DrawList& list, int offsetX, int offsetY, int tileSize) const
+{
+    if (!visible || tiles.empty()) return;
+
+    // both colours end up in the same geometry call of LAYER_OVERLAY
+    for (const Tile& t : tiles) {
+        SDL_FRect r = { static_cast<float>(t.x * tileSize + offsetX), static_cast<float>(t.y * tileSize + offsetY),
+                        static_cast<float>(tileSize), static_cast<float>(tileSize) };
+        if (t.danger == Danger::Caught) list.fillRect(LAYER_OVERLAY, r, { 220, 30, 30, 110 });
+        else list.fillRect(LAYER_OVERLAY, r, { 240, 150, 20, 100 });
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <vector>
+#include "bitboard.h"
+#include "../drawlist.h"
+
+// Tints the explorer's legal moves by what the (deterministic) mummy does next:
+// red = the mummy catches the explorer this turn, orange = every line of play
+// from that tile ends in capture within LOOKAHEAD_TURNS turns.
+// The analysis only runs when the explorer/mummy positions change, i.e. once per turn.
+// Before the move-by-move search, one bit-parallel test (Bitboard::mummyReach against the
+// explorer's Bitboard::distanceLayers) clears every tile the mummy cannot even get near.
+class DangerOverlay {
+public:
+    static const int LOOKAHEAD_TURNS = 3; // the turn being played included
+
+    void toggle() { visible = !visible; }
+    bool isVisible() const { return visible; }
+
+    // recompute if positions changed since the last call
+    void update(const Bitboard& board, int explorerX, int explorerY,
+                int mummyX, int mummyY, int exitX, int exitY);
+
+    // forget cached result (level change / restart)
+    void invalidate();
+
+    // one batched fill per tint colour
+    void render(DrawList& list, int offsetX, int offsetY, int tileSize) const;
+
+    // explorer stands on (ex,ey); mummy takes its two steps. true if it lands on the explorer.
+    static bool caughtThisTurn(const Bitboard& board, int ex, int ey, int& mx, int& my);
+
+private:
+    enum class Danger { Safe, Doomed, Caught };
+    struct Tile { int x, y; Danger danger; };
+
+    bool visible = false;
+    int lastEx = -1, lastEy = -1, lastMx = -1, lastMy = -1;
+    int exitX = -1, exitY = -1;
+    std::vector<Tile> tiles;
+
+    // false if no tile the explorer can be on within `turns` turns is within the mummy's
+    // reach: then no line of play can end in capture
+    static bool canMeet(const Bitboard& board, int ex, int ey, int mx, int my, int turns);
+    // true if the mummy catches the explorer within `turns` turns whatever the explorer does.
+    // Iterative: the positions reachable turn by turn, then decided from the last turn back
+    bool forcedCapture(const Bitboard& board, int ex, int ey, int mx, int my, int turns) const;
+};
@@ -1,4 +1,6 @@
 #include "panel.h"
+#include "../assets.h"
+#include <cmath>
 #include <iostream>
 #include "../functions.h"
 #include "../game.h"
@@ -22,9 +24,17 @@ bool Panel::create(SDL_Renderer* rend, int px, int py, int pw, int ph)
 void Panel::cleanup()
 {
     // free any owned resources
+    for (Child& c : children)
+        if (c.ownsImage) Assets::releaseTexture(c.image);
     children.clear();
+    layout.clear();
+    hitGrid.clear();
+    layoutW = layoutH = -1;
+    focusIndex = captureIndex = -1;
+    motionPending = false;
+    destroyCache();
     if (bgTexture) {
-        SDL_DestroyTexture(bgTexture);
+        Assets::releaseTexture(bgTexture);
         bgTexture = nullptr;
     }
 }
@@ -34,7 +44,7 @@ void Panel::setPosition(int px, int py) { x = px; y = py; }
 bool Panel::setBackgroundFromFile(const std::string& path)
 {
     if (!renderer) return false;
-    SDL_Texture* t = IMG_LoadTexture(renderer, path.c_str());
+    SDL_Texture* t = Assets::acquireTexture(renderer, path);
     if (!t) {
         std::cerr << "Panel::setBackgroundFromFile failed to load " << path << " | " << SDL_GetError() << "\n";
         return false;
@@ -43,12 +53,13 @@ bool Panel::setBackgroundFromFile(const std::string& path)
     float texW = 0.0f, texH = 0.0f;
     if (!SDL_GetTextureSize(t, &texW, &texH)) {
         std::cerr << "Panel::setBackgroundFromFile failed to get texture size " << path << " | " << SDL_GetError() << "\n";
-        SDL_DestroyTexture(t);
+        Assets::releaseTexture(t);
         return false;
     }
     
-    if (bgTexture) SDL_DestroyTexture(bgTexture);
+    if (bgTexture) Assets::releaseTexture(bgTexture);
     bgTexture = t;
+    cacheDirty = true;
 
     // set panel size to the image's size only if panel size is not already set.
     // This allows callers to create a panel at a specific size (e.g. 1750x900)
@@ -65,9 +76,10 @@ bool Panel::setBackgroundFromFile(const std::string& path)
 void Panel::clearBackground()
 {
     if (bgTexture) {
-        SDL_DestroyTexture(bgTexture);
+        Assets::releaseTexture(bgTexture);
         bgTexture = nullptr;
     }
+    cacheDirty = true;
 }
 
 Button* Panel::addButton(int localX, int localY, int bw, int bh,
@@ -120,6 +132,20 @@ Text* Panel::addText(const std::string& fontPath, int fontSize,
     return children.back().text.get();
 }
 
+bool Panel::setChildText(Text* text, const std::string& value)
+{
+    for (Child& c : children) {
+        if (c.type != Child::Type::Text || c.text.get() != text) continue;
+        if (!c.text->setText(value)) return false;
+        c.w = c.text->getWidth();
+        c.h = c.text->getHeight();
+        layout.clear(); // alignment depends on the size: recomputed before the next use
+        cacheDirty = true;
+        return true;
+    }
+    return false;
+}
+
 void Panel::addImage(SDL_Texture* tex, int localX, int localY, int iw, int ih, HAlign halign, VAlign valign)
 {
     if (!tex) return;
@@ -131,6 +157,18 @@ void Panel::addImage(SDL_Texture* tex, int localX, int localY, int iw, int ih, H
     children.push_back(std::move(c));
 }
 
+void Panel::addImageFromFile(const std::string& path, int localX, int localY, int iw, int ih,
+                             HAlign halign, VAlign valign)
+{
+    SDL_Texture* tex = Assets::acquireTexture(renderer, path);
+    if (!tex) {
+        std::cerr << "Panel::addImageFromFile failed to load " << path << " | " << SDL_GetError() << "\n";
+        return;
+    }
+    addImage(tex, localX, localY, iw, ih, halign, valign);
+    children.back().ownsImage = true;
+}
+
 Textbox* Panel::addTextbox(int localX, int localY, int w, int h,
                            const std::string& bgPath,
                            const std::string& placeholderText,
@@ -153,13 +191,11 @@ Textbox* Panel::addTextbox(int localX, int localY, int w, int h,
     return children.back().textbox.get();
 }
 
-SDL_FRect Panel::computeChildDst(const Child& c) const
+SDL_FRect Panel::computeLocalRect(const Child& c) const
 {
-    float absX = static_cast<float>(x);
-    float absY = static_cast<float>(y);
     // compute anchor point from panel + alignment
-    float baseX = absX;
-    float baseY = absY;
+    float baseX = 0.0f;
+    float baseY = 0.0f;
     switch (c.halign) {
         case HAlign::Left:   baseX += static_cast<float>(c.localX); break;
         case HAlign::Center: baseX += (w - c.w) * 0.5f + static_cast<float>(c.localX); break;
@@ -174,93 +210,288 @@ SDL_FRect Panel::computeChildDst(const Child& c) const
     return dst;
 }
 
+SDL_FRect Panel::computeChildDst(size_t index) const
+{
+    SDL_FRect dst = layout[index];
+    dst.x += static_cast<float>(x);
+    dst.y += static_cast<float>(y);
+    return dst;
+}
+
+void Panel::updateLayout()
+{
+    if (layout.size() == children.size() && layoutW == w && layoutH == h) return;
+    layoutW = w;
+    layoutH = h;
+    layout.resize(children.size());
+    for (size_t i = 0; i < children.size(); ++i) layout[i] = computeLocalRect(children[i]);
+
+    gridCols = std::max(1, (w + HIT_CELL - 1) / HIT_CELL);
+    gridRows = std::max(1, (h + HIT_CELL - 1) / HIT_CELL);
+    hitGrid.assign(static_cast<size_t>(gridCols * gridRows), {});
+    for (size_t i = 0; i < children.size(); ++i) {
+        if (children[i].type != Child::Type::Button && children[i].type != Child::Type::Textbox) continue;
+        const SDL_FRect& rc = layout[i];
+        const int c0 = std::max(0, static_cast<int>(std::floor(rc.x / HIT_CELL)));
+        const int r0 = std::max(0, static_cast<int>(std::floor(rc.y / HIT_CELL)));
+        const int c1 = std::min(gridCols - 1, static_cast<int>(std::floor((rc.x + rc.w - 1) / HIT_CELL)));
+        const int r1 = std::min(gridRows - 1, static_cast<int>(std::floor((rc.y + rc.h - 1) / HIT_CELL)));
+        for (int gy = r0; gy <= r1; ++gy)
+            for (int gx = c0; gx <= c1; ++gx)
+                hitGrid[gy * gridCols + gx].push_back(static_cast<int>(i)); // ascending = child order
+    }
+    if (focusIndex >= static_cast<int>(children.size())) focusIndex = -1;
+    if (captureIndex >= static_cast<int>(children.size())) captureIndex = -1;
+}
+
+bool Panel::toLocal(float sx, float sy, float& lx, float& ly) const
+{
+    // event coords are window pixels; layout is in logical (render-scaled) units like Button
+    float scaleX = 1.0f, scaleY = 1.0f;
+    SDL_GetRenderScale(renderer, &scaleX, &scaleY);
+    lx = sx / scaleX - static_cast<float>(x);
+    ly = sy / scaleY - static_cast<float>(y);
+    return lx >= 0.0f && ly >= 0.0f && lx < static_cast<float>(w) && ly < static_cast<float>(h);
+}
+
+int Panel::hitTest(float lx, float ly) const
+{
+    if (lx < 0.0f || ly < 0.0f || lx >= static_cast<float>(w) || ly >= static_cast<float>(h) || hitGrid.empty())
+        return -1;
+    const int gx = std::min(gridCols - 1, static_cast<int>(lx) / HIT_CELL);
+    const int gy = std::min(gridRows - 1, static_cast<int>(ly) / HIT_CELL);
+    for (int i : hitGrid[gy * gridCols + gx]) {
+        const SDL_FRect& rc = layout[i];
+        if (lx >= rc.x && lx < rc.x + rc.w && ly >= rc.y && ly < rc.y + rc.h) return i;
+    }
+    return -1;
+}
+
+void Panel::setFocus(int index)
+{
+    if (index == focusIndex) return;
+    if (focusIndex >= 0 && children[focusIndex].textbox) children[focusIndex].textbox->setFocused(false);
+    focusIndex = index;
+    if (focusIndex >= 0 && children[focusIndex].textbox) children[focusIndex].textbox->setFocused(true);
+}
+
+void Panel::dispatchMouse(int index, const SDL_Event& e)
+{
+    Child& c = children[index];
+    if (c.type != Child::Type::Button || !c.button) return;
+    SDL_FRect dst = computeChildDst(static_cast<size_t>(index));
+    c.button->setPosition(static_cast<int>(dst.x), static_cast<int>(dst.y));
+    c.button->setSize(static_cast<int>(dst.w), static_cast<int>(dst.h));
+    c.button->handleEvent(e); // may rebuild this panel (callback): do not touch children after
+}
+
 void Panel::handleEvent(const SDL_Event& e)
 {
-    // Always forward keyboard/text events and mouse events to textboxes,
-    // because textboxes need to react to keyboard input even if the event
-    // isn't a mouse event.
-    // First, update textbox positions/sizes and forward the event.
-    for (auto &c : children) {
-        if (c.type == Child::Type::Textbox && c.textbox) {
-            SDL_FRect dst = computeChildDst(c);
-            c.textbox->setPosition(static_cast<int>(dst.x), static_cast<int>(dst.y));
-            c.textbox->setSize(static_cast<int>(dst.w), static_cast<int>(dst.h));
-            c.textbox->handleEvent(e); // forward ALL events (mouse + keyboard + text)
+    // render target contents are lost on target reset, the texture itself on device reset
+    if (e.type == SDL_EVENT_RENDER_TARGETS_RESET) { cacheDirty = true; return; }
+    if (e.type == SDL_EVENT_RENDER_DEVICE_RESET) { destroyCache(); return; }
+
+    updateLayout();
+    float lx = 0.0f, ly = 0.0f;
+    switch (e.type) {
+        case SDL_EVENT_KEY_DOWN:
+        case SDL_EVENT_KEY_UP:
+        case SDL_EVENT_TEXT_INPUT:
+        case SDL_EVENT_TEXT_EDITING:
+            if (focusIndex >= 0 && children[focusIndex].textbox)
+                children[focusIndex].textbox->handleEvent(e);
+            break;
+
+        case SDL_EVENT_MOUSE_MOTION:
+            // only the latest position matters; delivered in render()
+            pendingMotion = e;
+            motionPending = true;
+            break;
+
+        case SDL_EVENT_MOUSE_BUTTON_DOWN: {
+            toLocal(e.button.x, e.button.y, lx, ly);
+            const int hit = hitTest(lx, ly);
+            const bool isTextbox = hit >= 0 && children[hit].type == Child::Type::Textbox;
+            if (e.button.button == SDL_BUTTON_LEFT) setFocus(isTextbox ? hit : -1); // click elsewhere drops focus
+            if (hit >= 0 && !isTextbox) {
+                captureIndex = hit;
+                dispatchMouse(hit, e);
+            }
+            break;
+        }
+
+        case SDL_EVENT_MOUSE_BUTTON_UP: {
+            // the pressed button gets its release even off the button, so it can un-press
+            int target = captureIndex;
+            captureIndex = -1;
+            if (target < 0) {
+                toLocal(e.button.x, e.button.y, lx, ly);
+                target = hitTest(lx, ly);
+            }
+            if (target >= 0) dispatchMouse(target, e);
+            break;
         }
+
+        default:
+            break;
     }
+}
 
-    // Now handle mouse-only behavior for clicking buttons
-    if (e.type == SDL_EVENT_MOUSE_BUTTON_DOWN || e.type == SDL_EVENT_MOUSE_BUTTON_UP ||
-        e.type == SDL_EVENT_MOUSE_MOTION || e.type == SDL_EVENT_MOUSE_WHEEL)
-    {
-        int mx = 0, my = 0;
-        if (e.type == SDL_EVENT_MOUSE_MOTION) { mx = e.motion.x; my = e.motion.y; }
-        else { mx = e.button.x; my = e.button.y; }
-
-        auto inside = [&](int mx_, int my_)->bool {
-            return mx_ >= x && mx_ < x + w && my_ >= y && my_ < y + h;
-        };
-        if (!inside(mx, my)) return;
-
-        // forward mouse to the first button under the cursor (topmost)
-        for (auto &c : children) {
-            if (c.type != Child::Type::Button) continue;
-            SDL_FRect dst = computeChildDst(c);
-            bool overChild = (mx >= dst.x && mx < dst.x + dst.w && my >= dst.y && my < dst.y + dst.h);
-            if (overChild) {
+void Panel::flushMotion()
+{
+    if (!motionPending) return;
+    motionPending = false;
+    float lx = 0.0f, ly = 0.0f;
+    toLocal(pendingMotion.motion.x, pendingMotion.motion.y, lx, ly);
+    const int target = captureIndex >= 0 ? captureIndex : hitTest(lx, ly);
+    if (target >= 0) dispatchMouse(target, pendingMotion);
+}
+
+void Panel::renderChild(size_t index)
+{
+    const Child& c = children[index];
+    SDL_FRect dst = computeChildDst(index);
+    switch (c.type) {
+        case Child::Type::Button:
+            if (c.button) {
                 c.button->setPosition(static_cast<int>(dst.x), static_cast<int>(dst.y));
                 c.button->setSize(static_cast<int>(dst.w), static_cast<int>(dst.h));
-                c.button->handleEvent(e);
-                return;
+                c.button->render();
             }
-        }
+            break;
+
+        case Child::Type::Text:
+            if (c.text) {
+                c.text->setPosition(static_cast<int>(dst.x), static_cast<int>(dst.y));
+                c.text->render();
+            }
+            break;
+
+        case Child::Type::Image:
+            if (c.image) {
+                SDL_RenderTexture(renderer, c.image, nullptr, &dst);
+            }
+            break;
+        
+        case Child::Type::Textbox:
+            if (c.textbox) {
+                c.textbox->setPosition(static_cast<int>(dst.x), static_cast<int>(dst.y));
+                c.textbox->setSize(static_cast<int>(dst.w), static_cast<int>(dst.h));
+                c.textbox->render();
+            }
+            break;
     }
 }
 
-void Panel::render()
+uint64_t Panel::computeCacheKey(float scaleX, float scaleY) const
 {
-    if (!renderer) return;
+    uint64_t k = 1469598103934665603ull;
+    auto mix = [&k](uint64_t v) { k = (k ^ v) * 1099511628211ull; };
+    mix(reinterpret_cast<uintptr_t>(bgTexture));
+    mix(static_cast<uint64_t>(w) << 32 | static_cast<uint32_t>(h));
+    mix(static_cast<uint64_t>(scaleX * 1000.0f) << 32 | static_cast<uint32_t>(scaleY * 1000.0f));
+    mix(children.size());
+    for (const auto& c : children) {
+        mix(static_cast<uint64_t>(c.type));
+        if (c.button) mix(c.button->getVersion());
+        if (c.text) mix(c.text->getVersion());
+        if (c.image) mix(reinterpret_cast<uintptr_t>(c.image));
+    }
+    return k;
+}
 
-    // draw background (stretched to panel size)
+void Panel::destroyCache()
+{
+    if (cache) {
+        SDL_DestroyTexture(cache);
+        cache = nullptr;
+    }
+    cacheDirty = true;
+}
+
+bool Panel::rebuildCache(float scaleX, float scaleY)
+{
+    const int tw = static_cast<int>(std::ceil(w * scaleX));
+    const int th = static_cast<int>(std::ceil(h * scaleY));
+    if (tw <= 0 || th <= 0) return false;
+
+    if (cache) {
+        float cw = 0.0f, ch = 0.0f;
+        SDL_GetTextureSize(cache, &cw, &ch);
+        if (static_cast<int>(cw) != tw || static_cast<int>(ch) != th) destroyCache();
+    }
+    if (!cache) {
+        cache = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, tw, th);
+        if (!cache) return false; // no render targets: Panel::render falls back to drawing live
+        // drawing with normal blending over a cleared target leaves premultiplied pixels
+        SDL_SetTextureBlendMode(cache, SDL_BLENDMODE_BLEND_PREMULTIPLIED);
+    }
+
+    SDL_Texture* prevTarget = SDL_GetRenderTarget(renderer);
+    if (!SDL_SetRenderTarget(renderer, cache)) return false;
+    SDL_SetRenderScale(renderer, scaleX, scaleY); // scale is per target; the window's is untouched
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    // draw in panel-local coordinates
+    const int savedX = x, savedY = y;
+    x = 0; y = 0;
     if (bgTexture) {
-        SDL_FRect dst = { static_cast<float>(x), static_cast<float>(y), static_cast<float>(w), static_cast<float>(h) };
+        SDL_FRect dst = { 0.0f, 0.0f, static_cast<float>(w), static_cast<float>(h) };
         SDL_RenderTexture(renderer, bgTexture, nullptr, &dst);
     }
+    for (size_t i = 0; i < children.size(); ++i) {
+        if (children[i].type != Child::Type::Textbox) renderChild(i);
+    }
+    x = savedX; y = savedY;
 
-    // render children
-    for (const auto &c : children) {
-        SDL_FRect dst = computeChildDst(c);
-        switch (c.type) {
-            case Child::Type::Button:
-                if (c.button) {
-                    c.button->setPosition(static_cast<int>(dst.x), static_cast<int>(dst.y));
-                    c.button->setSize(static_cast<int>(dst.w), static_cast<int>(dst.h));
-                    c.button->render();
-                }
-                break;
+    SDL_SetRenderTarget(renderer, prevTarget);
+    return true;
+}
 
-            case Child::Type::Text:
-                if (c.text) {
-                    c.text->setPosition(static_cast<int>(dst.x), static_cast<int>(dst.y));
-                    c.text->render();
-                }
-                break;
+void Panel::render()
+{
+    if (!renderer) return;
+    updateLayout();
+    flushMotion();
+    if (children.size() != layout.size()) updateLayout(); // hover callback changed the panel
+
+    float scaleX = 1.0f, scaleY = 1.0f;
+    SDL_GetRenderScale(renderer, &scaleX, &scaleY);
+    const uint64_t key = computeCacheKey(scaleX, scaleY);
+    if (cacheDirty || key != cacheKey || !cache) {
+        cacheDirty = !rebuildCache(scaleX, scaleY);
+        cacheKey = key;
+    }
 
-            case Child::Type::Image:
-                if (c.image) {
-                    SDL_RenderTexture(renderer, c.image, nullptr, &dst);
-                }
-                break;
-            
-            case Child::Type::Textbox:
-                if (c.textbox) {
-                    c.textbox->setPosition(static_cast<int>(dst.x), static_cast<int>(dst.y));
-                    c.textbox->setSize(static_cast<int>(dst.w), static_cast<int>(dst.h));
-                    c.textbox->render();
-                }
-                break;
+    if (!cacheDirty && cache) {
+        SDL_FRect dst = { static_cast<float>(x), static_cast<float>(y), static_cast<float>(w), static_cast<float>(h) };
+        SDL_RenderTexture(renderer, cache, nullptr, &dst);
+    } else {
+        // draw background (stretched to panel size)
+        if (bgTexture) {
+            SDL_FRect dst = { static_cast<float>(x), static_cast<float>(y), static_cast<float>(w), static_cast<float>(h) };
+            SDL_RenderTexture(renderer, bgTexture, nullptr, &dst);
+        }
+        for (size_t i = 0; i < children.size(); ++i) {
+            if (children[i].type != Child::Type::Textbox) renderChild(i);
         }
     }
+
+    // dynamic children on top
+    for (size_t i = 0; i < children.size(); ++i) {
+        if (children[i].type == Child::Type::Textbox) renderChild(i);
+    }
+}
+
+void Panel::prewarm()
+{
+    if (!renderer) return;
+    updateLayout();
+    float scaleX = 1.0f, scaleY = 1.0f;
+    SDL_GetRenderScale(renderer, &scaleX, &scaleY);
+    cacheKey = computeCacheKey(scaleX, scaleY);
+    cacheDirty = !rebuildCache(scaleX, scaleY);
 }
 
 int Panel::getX() const { return x; }
@@ -283,9 +514,8 @@ bool IngamePanel::initForStage(Game* owner,
     setPosition(panelX, panelY);
 
     // add title image centered near top (3% down), size 300x200
-    SDL_Texture* titleTex = IMG_LoadTexture(renderer, "assets/images/title.png");
     int yText = static_cast<int>(getHeight() * 0.15f);
-    addImage(titleTex, 0, yText, 300, 150, HAlign::Center, VAlign::Top);
+    addImageFromFile("assets/images/title.png", 0, yText, 300, 150, HAlign::Center, VAlign::Top);
 
     // add buttons (centered, stacked with 16px padding)
     SDL_Color btnCol = { 0xf9, 0xf2, 0x6a, 0xFF };
@@ -522,7 +752,7 @@ void AccountPanel::buildMainMenu()
                 if (!userPtr) return;
                 userPtr->logout();
                 // Vừa logout thì reset UI về giao diện đăng ký/đăng nhập ngay
-                bool hasFile = userPtr->read();
+                bool hasFile = userPtr->hasAccounts();
                 if (!hasFile) {
                     mode = Mode::FirstRunCreate;
                     buildFirstRunCreate();
@@ -733,7 +963,7 @@ bool SettingsPanel::init(User* user, int winW, int winH, std::function<void()> o
             accountBtn->setLabelPositionPercent(0.5f, 0.70f);
             accountBtn->setCallback([this, user, winW, winH, onChanged]() {
                 if (!user) return;
-                bool hasUserFile = user->read();
+                bool hasUserFile = user->hasAccounts();
                 AccountPanel::init(user, hasUserFile, winW, winH, onChanged);
                 // Giữ nguyên vị trí panel hiện tại
             });
@@ -809,6 +1039,7 @@ VictoryPanel::VictoryPanel(SDL_Renderer* renderer) : Panel(renderer) {}
 
 bool VictoryPanel::init(int winW, int winH, std::function<void()> onNextLevel) {
     if (!create(renderer, 0, 0, winW, winH)) return false;
+    onNext = std::move(onNextLevel);
     if (!setBackgroundFromFile("assets/images/panel/settingsPanel.png")) return false;
 
     const SDL_Color titleCol = {255, 215, 0, 255}; // Gold color
@@ -826,25 +1057,78 @@ bool VictoryPanel::init(int winW, int winH, std::function<void()> onNextLevel) {
     Button* nextBtn = addButton(0, btnY, BtnW, BtnH, "NEXT", 72, btnCol, "assets/font.ttf", HAlign::Center, VAlign::Top);
     if (nextBtn) {
         nextBtn->setLabelPositionPercent(0.5f, 0.70f);
-        nextBtn->setCallback([onNextLevel]() {
-            if (onNextLevel) onNextLevel();
+        nextBtn->setCallback([this]() {
+            if (onNext) onNext();
         });
     }
 
-    // play victory sound once (respect current music enabled state)
+    // kết quả lượt này + kỷ lục / bảng xếp hạng (điền sau bằng setResult / setRecord)
+    const SDL_Color infoCol = {0xf9, 0xf2, 0x6a, 0xFF};
+    const int infoFontSize = 44;
+    const int lineH = 52;
+    int infoY = btnY + BtnH + 30;
+    resultText = addText("assets/font.ttf", infoFontSize, "", infoCol, 0, infoY, HAlign::Center, VAlign::Top);
+    bestText = addText("assets/font.ttf", infoFontSize, "", infoCol, 0, infoY + lineH, HAlign::Center, VAlign::Top);
+    rankText = addText("assets/font.ttf", infoFontSize, "", infoCol, 0, infoY + 2 * lineH, HAlign::Center, VAlign::Top);
+    for (int i = 0; i < TOP_ROWS; ++i)
+        topText[i] = addText("assets/font.ttf", infoFontSize - 6, "", SDL_Color{255, 255, 255, 255},
+                             0, infoY + 3 * lineH + 10 + i * (lineH - 6), HAlign::Center, VAlign::Top);
+
+    return true;
+}
+
+void VictoryPanel::open(std::function<void()> onNextLevel)
+{
+    onNext = std::move(onNextLevel);
+    // kỷ lục / bảng xếp hạng của lượt trước: để trống tới khi setRecord có số mới
+    setChildText(bestText, "");
+    setChildText(rankText, "");
+    for (int i = 0; i < TOP_ROWS; ++i) setChildText(topText[i], "");
+
+    // play victory sound once (preloaded in the mixer's bank)
     if (g_audioInstance) {
-        if (!g_audioInstance->playOneShot("assets/audio/victory.wav")) {
+        if (!g_audioInstance->play(Sfx::Victory)) {
             std::cerr << "VictoryPanel: failed to play victory.wav\n";
         }
     }
+}
 
-    return true;
+// m:ss.t
+static std::string formatTime(uint32_t ms)
+{
+    const uint32_t tenths = ms / 100;
+    char buf[32];
+    SDL_snprintf(buf, sizeof(buf), "%u:%02u.%u", tenths / 600, (tenths / 10) % 60, tenths % 10);
+    return buf;
+}
+
+void VictoryPanel::setResult(int moves, int timeMs)
+{
+    setChildText(resultText, "MOVES " + std::to_string(moves) + "   TIME " + formatTime(static_cast<uint32_t>(std::max(timeMs, 0))));
+}
+
+void VictoryPanel::setRecord(const LevelStats& mine, size_t rank, size_t ranked,
+                             const std::vector<Leaderboards::Standing>& top)
+{
+    if (mine.cleared())
+        setChildText(bestText, "BEST " + std::to_string(mine.bestMoves) + " MOVES  " + formatTime(mine.bestTimeMs) +
+                               "   ATTEMPTS " + std::to_string(mine.attempts));
+    if (rank > 0)
+        setChildText(rankText, "RANK " + std::to_string(rank) + " OF " + std::to_string(ranked));
+    for (int i = 0; i < TOP_ROWS; ++i) {
+        std::string line;
+        if (static_cast<size_t>(i) < top.size())
+            line = std::to_string(i + 1) + ". " + top[i].username + "  " + std::to_string(top[i].moves) +
+                   " MOVES  " + formatTime(top[i].timeMs);
+        setChildText(topText[i], line);
+    }
 }
 
 LostPanel::LostPanel(SDL_Renderer* renderer) : Panel(renderer) {}
 
 bool LostPanel::init(int winW, int winH, std::function<void()> onPlayAgain) {
     if (!create(renderer, 0, 0, winW, winH)) return false;
+    onRetry = std::move(onPlayAgain);
     if (!setBackgroundFromFile("assets/images/panel/settingsPanel.png")) return false;
 
     const SDL_Color titleCol = {255, 0, 0, 255}; // Red color
@@ -862,17 +1146,22 @@ bool LostPanel::init(int winW, int winH, std::function<void()> onPlayAgain) {
     Button* playAgainBtn = addButton(0, btnY, BtnW, BtnH, "RETRY", 72, btnCol, "assets/font.ttf", HAlign::Center, VAlign::Top);
     if (playAgainBtn) {
         playAgainBtn->setLabelPositionPercent(0.5f, 0.70f);
-        playAgainBtn->setCallback([onPlayAgain]() {
-            if (onPlayAgain) onPlayAgain();
+        playAgainBtn->setCallback([this]() {
+            if (onRetry) onRetry();
         });
     }
 
-    // play lost sound once (respect current music enabled state)
+    return true;
+}
+
+void LostPanel::open(std::function<void()> onPlayAgain)
+{
+    onRetry = std::move(onPlayAgain);
+
+    // play lost sound once (preloaded in the mixer's bank)
     if (g_audioInstance) {
-        if (!g_audioInstance->playOneShot("assets/audio/lost.wav")) {
+        if (!g_audioInstance->play(Sfx::Lost)) {
             std::cerr << "LostPanel: failed to play lost.wav\n";
         }
     }
-
-    return true;
 }
\ No newline at end of file
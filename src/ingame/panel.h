@@ -53,6 +53,10 @@ public:
     void addImage(SDL_Texture* tex, int localX, int localY, int w, int h,
                   HAlign halign = HAlign::Left,
                   VAlign valign = VAlign::Top);
+    // image from the shared texture cache, released again in cleanup()
+    void addImageFromFile(const std::string& path, int localX, int localY, int w, int h,
+                          HAlign halign = HAlign::Left,
+                          VAlign valign = VAlign::Top);
 
     // add textbox
     Textbox* addTextbox(int localX, int localY, int w, int h,
@@ -64,12 +68,20 @@ public:
                     HAlign halign = HAlign::Left,
                     VAlign valign = VAlign::Top);
 
-    // event forwarding (mouse coords are translated into panel-local for children)
+    // event forwarding: mouse buttons are hit-tested against the cached layout, keyboard
+    // and text input go only to the focused textbox, mouse motion is coalesced and
+    // delivered once per frame from render()
     void handleEvent(const SDL_Event& e);
 
     // draw all children (positions are relative to panel)
     void render();
 
+    // force the composited cache to be rebuilt (e.g. an image child's texture was redrawn)
+    void invalidate() { cacheDirty = true; }
+    // lay out and composite the cache now (at the current render scale), so the first
+    // frame that shows a pre-built panel only draws it
+    void prewarm();
+
     // getters
     int getX() const;
     int getY() const;
@@ -78,6 +90,8 @@ public:
 
 protected:
     SDL_Renderer* renderer = nullptr;
+    // change a text child added with addText(); its size and the layout follow
+    bool setChildText(Text* text, const std::string& value);
 private:
     struct Child {
         enum class Type { Button, Text, Image, Textbox } type;
@@ -85,6 +99,7 @@ private:
         std::unique_ptr<Text> text;
         std::unique_ptr<Textbox> textbox;
         SDL_Texture* image = nullptr;
+        bool ownsImage = false; // acquired through Assets::acquireTexture
         int localX = 0;
         int localY = 0;
         int w = 0, h = 0;
@@ -96,8 +111,40 @@ private:
     int x = 0, y = 0, w = 0, h = 0;
     std::vector<Child> children;
 
+    // Background, texts, images and buttons are composited once into `cache` (a render
+    // target at output resolution) and drawn with a single SDL_RenderTexture; only
+    // textboxes (cursor blink, typing) are drawn live on top. The cache is rebuilt when
+    // the key over children's versions / background / size / render scale changes.
+    SDL_Texture* cache = nullptr;
+    uint64_t cacheKey = 0;
+    bool cacheDirty = true;
+
+    // panel-local rect per child, recomputed only when children or the panel size change
+    std::vector<SDL_FRect> layout;
+    int layoutW = -1, layoutH = -1;
+    // uniform grid over the panel; each cell lists the buttons/textboxes overlapping it
+    static const int HIT_CELL = 64;
+    int gridCols = 0, gridRows = 0;
+    std::vector<std::vector<int>> hitGrid;
+
+    int focusIndex = -1;   // textbox receiving keyboard / text input
+    int captureIndex = -1; // button that took the mouse down; gets the matching up
+    bool motionPending = false;
+    SDL_Event pendingMotion{};
+
     // helpers
-    SDL_FRect computeChildDst(const Child& c) const;
+    SDL_FRect computeLocalRect(const Child& c) const;
+    SDL_FRect computeChildDst(size_t index) const;
+    void updateLayout();
+    bool toLocal(float sx, float sy, float& lx, float& ly) const;
+    int hitTest(float lx, float ly) const;
+    void setFocus(int index);
+    void dispatchMouse(int index, const SDL_Event& e);
+    void flushMotion();
+    void renderChild(size_t index);
+    uint64_t computeCacheKey(float scaleX, float scaleY) const;
+    bool rebuildCache(float scaleX, float scaleY);
+    void destroyCache();
 };
 
 class Game;
@@ -152,14 +199,36 @@ class SettingsPanel : public AccountPanel {
         bool init(User* user, int winW, int winH, std::function<void()> onChanged = nullptr, 
                   bool isInGame = false, std::function<void()> onQuitGame = nullptr);
 };
+// Victory / Lost are built once per Game scene and kept hidden; open() re-binds the
+// button callback and plays the (preloaded) sound, so showing one loads nothing.
 class VictoryPanel : public Panel {
     public:
+        static const int TOP_ROWS = 3;
+
         VictoryPanel(SDL_Renderer* renderer = nullptr);
-        bool init(int winW, int winH, std::function<void()> onNextLevel);
+        bool init(int winW, int winH, std::function<void()> onNextLevel = nullptr);
+        // about to be shown: NEXT calls onNextLevel, lines of the previous run are cleared
+        void open(std::function<void()> onNextLevel);
+
+        // this run: shown as soon as the panel opens
+        void setResult(int moves, int timeMs);
+        // the player's records and the level's leaderboard, once the store has them
+        void setRecord(const LevelStats& mine, size_t rank, size_t ranked,
+                       const std::vector<Leaderboards::Standing>& top);
+    private:
+        std::function<void()> onNext;
+        Text* resultText = nullptr;
+        Text* bestText = nullptr;
+        Text* rankText = nullptr;
+        Text* topText[TOP_ROWS] = {};
     };
     
 class LostPanel : public Panel {
     public:
         LostPanel(SDL_Renderer* renderer = nullptr);
-        bool init(int winW, int winH, std::function<void()> onPlayAgain);
+        bool init(int winW, int winH, std::function<void()> onPlayAgain = nullptr);
+        // about to be shown: RETRY calls onPlayAgain
+        void open(std::function<void()> onPlayAgain);
+    private:
+        std::function<void()> onRetry;
     };
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "pathcache.h"
+#include <algorithm>
+
+void PathCache::reset(const Bitboard* b)
+{
+    board = b;
+    rows = b ? b->getRows() : 0;
+    cols = b ? b->getCols() : 0;
+    trees.clear();
+    trees.resize(static_cast<size_t>(rows * cols));
+}
+
+const std::vector<int32_t>& PathCache::treeFor(int sx, int sy)
+{
+    std::vector<int32_t>& tree = trees[sy * cols + sx];
+    if (!tree.empty()) return tree;
+
+    tree.assign(static_cast<size_t>(rows * cols), -1);
+    std::vector<int> queue;
+    queue.reserve(static_cast<size_t>(rows * cols));
+    tree[sy * cols + sx] = -2;
+    queue.push_back(sy * cols + sx);
+    const int d4[4][2] = { {0,-1}, {1,0}, {0,1}, {-1,0} };
+    for (size_t i = 0; i < queue.size(); ++i) {
+        int cx = queue[i] % cols, cy = queue[i] / cols;
+        for (const auto& d : d4) {
+            if (!board->canStep(cx, cy, d[0], d[1])) continue;
+            int n = (cy + d[1]) * cols + (cx + d[0]);
+            if (tree[n] != -1) continue;
+            tree[n] = queue[i];
+            queue.push_back(n);
+        }
+    }
+    return tree;
+}
+
+bool PathCache::findPath(int sx, int sy, int tx, int ty, std::vector<SDL_Point>& out)
+{
+    out.clear();
+    if (!board || sx < 0 || sy < 0 || sx >= cols || sy >= rows) return false;
+    if (tx < 0 || ty < 0 || tx >= cols || ty >= rows) return false;
+    if (sx == tx && sy == ty) return false;
+
+    const std::vector<int32_t>& tree = treeFor(sx, sy);
+    int cur = ty * cols + tx;
+    if (tree[cur] == -1) return false;
+    while (tree[cur] != -2) {
+        out.push_back({ cur % cols, cur / cols });
+        cur = tree[cur];
+    }
+    std::reverse(out.begin(), out.end());
+    return true;
+}
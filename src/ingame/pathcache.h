@@ -0,0 +1,30 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <vector>
+#include "bitboard.h"
+
+// Shortest explorer paths over the current level.
+// A BFS parent tree is built the first time a tile is used as a path source and
+// kept until the level changes, so repeated queries (mouse hover every frame)
+// only walk the cached tree back from the target.
+// Memory is O(cells^2) in the worst case: every source tile used keeps one 4-byte entry
+// per cell (a 64x64 map with every tile used as a source: 4096 trees x 16 KB = 64 MB).
+// In play only the tiles the explorer stood on become sources.
+class PathCache {
+public:
+    // drop every cached tree; call on level change
+    void reset(const Bitboard* board);
+
+    // path from (sx,sy) to (tx,ty), excluding the start tile. false if unreachable.
+    bool findPath(int sx, int sy, int tx, int ty, std::vector<SDL_Point>& out);
+
+private:
+    const Bitboard* board = nullptr;
+    int rows = 0, cols = 0;
+    // trees[source] = parent cell index for every cell, -1 = unreached, -2 = source
+    // (32-bit: Map does not limit rows * cols)
+    std::vector<std::vector<int32_t>> trees;
+
+    const std::vector<int32_t>& treeFor(int sx, int sy);
+};
@@ -1,4 +1,5 @@
 #include "textbox.h"
+#include "../assets.h"
 #include <cstring>
 #include <iostream>
 #include <algorithm>
@@ -23,7 +24,7 @@ bool Textbox::create(SDL_Renderer* rend, int x, int y, int w, int h,
     cursorPos = 0;
     
     // load background texture
-    bgTexture = IMG_LoadTexture(renderer, bgPath.c_str());
+    bgTexture = Assets::acquireTexture(renderer, bgPath);
     if (!bgTexture) {
         std::cerr << "Textbox::create - failed to load " << bgPath << " | " << SDL_GetError() << "\n";
         return false;
@@ -106,18 +107,7 @@ void Textbox::handleEvent(const SDL_Event& e)
         int mx = e.button.x;
         int my = e.button.y;
         bool inside = (mx >= rect.x && mx < rect.x + rect.w && my >= rect.y && my < rect.y + rect.h);
-        if (inside && !focused) {
-            focused = true;
-            cursorPos = currentInput.length();  // place cursor at end on initial focus
-            lastCursorToggle = SDL_GetTicks();
-            cursorVisible = true;
-            SDL_StartTextInput(SDL_GetKeyboardFocus());
-            updateDisplayText();
-        } else if (!inside && focused) {
-            focused = false;
-            SDL_StopTextInput(SDL_GetKeyboardFocus());
-            updateDisplayText();
-        }
+        setFocused(inside);
     }
     
     // handle text input (insert at cursor position)
@@ -219,6 +209,21 @@ void Textbox::render()
     }
 }
 
+void Textbox::setFocused(bool f)
+{
+    if (f == focused) return;
+    focused = f;
+    if (focused) {
+        cursorPos = currentInput.length();  // place cursor at end on initial focus
+        lastCursorToggle = SDL_GetTicks();
+        cursorVisible = true;
+        SDL_StartTextInput(SDL_GetKeyboardFocus());
+    } else {
+        SDL_StopTextInput(SDL_GetKeyboardFocus());
+    }
+    updateDisplayText();
+}
+
 void Textbox::setText(const std::string& text)
 {
     currentInput = text;
@@ -234,7 +239,7 @@ void Textbox::cleanup()
     }
 
     if (bgTexture) {
-        SDL_DestroyTexture(bgTexture);
+        Assets::releaseTexture(bgTexture);
         bgTexture = nullptr;
     }
     if (placeholder) {
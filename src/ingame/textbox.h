@@ -49,6 +49,10 @@ public:
     
     void handleEvent(const SDL_Event& e);
     void render();
+
+    // keyboard focus (starts/stops SDL text input); Panel drives this from its hit test
+    void setFocused(bool f);
+    bool isFocused() const { return focused; }
     
     std::string getText() const { return currentInput; }
     void setText(const std::string& text);
@@ -0,0 +1,132 @@
+#include "jobs.h"
+
+namespace {
+// index of the pool worker running on this thread, -1 elsewhere
+thread_local int workerIndex = -1;
+}
+
+void JobGroup::wait()
+{
+    // help with this group's jobs, so waiting from the main thread also adds a core
+    while (!done() && JobPool::instance().runOne(this)) {}
+    // the rest are running on workers; taking the lock also waits for the last one to
+    // leave notify, so the group can be destroyed as soon as this returns
+    std::unique_lock<std::mutex> lk(lock);
+    finished.wait(lk, [this]() { return done(); });
+}
+
+JobPool& JobPool::instance()
+{
+    static JobPool pool;
+    return pool;
+}
+
+JobPool::JobPool()
+{
+    unsigned n = std::thread::hardware_concurrency();
+    int count = n > 1 ? static_cast<int>(n) - 1 : 1; // main thread helps in JobGroup::wait
+    for (int i = 0; i < count; ++i) queues.push_back(std::make_unique<Queue>());
+    for (int i = 0; i < count; ++i) workers.emplace_back([this, i]() { workerLoop(i); });
+}
+
+JobPool::~JobPool()
+{
+    {
+        std::lock_guard<std::mutex> lk(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+void JobPool::submit(Job job, JobGroup* group)
+{
+    if (group) group->pending.fetch_add(1, std::memory_order_relaxed);
+    const size_t target = workerIndex >= 0 ? static_cast<size_t>(workerIndex)
+                                           : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    Queue& q = *queues[target];
+    {
+        std::lock_guard<std::mutex> lk(q.lock);
+        q.tasks.push_back({ std::move(job), group });
+    }
+    queued.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lk(sleepLock); // pairs with the predicate check in workerLoop
+    }
+    wake.notify_one();
+}
+
+bool JobPool::popOrSteal(int self, Task& out)
+{
+    const int n = static_cast<int>(queues.size());
+    if (self >= 0) {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lk(own.lock);
+        if (!own.tasks.empty()) {
+            out = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    for (int k = 1; k <= n; ++k) {
+        int victim = ((self < 0 ? 0 : self) + k) % n;
+        Queue& q = *queues[victim];
+        std::lock_guard<std::mutex> lk(q.lock);
+        if (!q.tasks.empty()) {
+            out = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobPool::popGroup(JobGroup* group, Task& out)
+{
+    for (auto& qp : queues) {
+        Queue& q = *qp;
+        std::lock_guard<std::mutex> lk(q.lock);
+        for (auto it = q.tasks.begin(); it != q.tasks.end(); ++it) {
+            if (it->group != group) continue;
+            out = std::move(*it);
+            q.tasks.erase(it);
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobPool::run(Task& t)
+{
+    t.job();
+    if (!t.group) return;
+    JobGroup* g = t.group;
+    std::lock_guard<std::mutex> lk(g->lock);
+    if (g->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) g->finished.notify_all();
+}
+
+bool JobPool::runOne(JobGroup* group)
+{
+    Task t;
+    if (!group || !popGroup(group, t)) return false;
+    run(t);
+    return true;
+}
+
+void JobPool::workerLoop(int index)
+{
+    workerIndex = index;
+    for (;;) {
+        Task t;
+        if (popOrSteal(index, t)) {
+            run(t);
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(sleepLock);
+        wake.wait(lk, [this]() { return stopping || queued.load(std::memory_order_acquire) > 0; });
+        if (stopping) return;
+    }
+}
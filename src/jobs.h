@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts outstanding jobs submitted with it. wait() runs the group's own queued jobs on the
+// calling thread and then sleeps until the ones already taken by workers finish; it never
+// runs another group's job, so a wait on the render thread costs only what it waits for.
+class JobGroup {
+public:
+    void wait();
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobPool;
+    std::atomic<int> pending{0};
+    std::mutex lock;               // the last job finishing notifies under it
+    std::condition_variable finished;
+};
+
+// Small work-stealing thread pool shared by the whole game.
+// Every worker owns a deque: it pops its own jobs from the back and steals from the
+// front of the others when empty. A job submitted by a worker goes to that worker's
+// deque (its data is likely still in that core's cache); jobs submitted from outside the
+// pool are spread round-robin across the workers.
+class JobPool {
+public:
+    using Job = std::function<void()>;
+
+    static JobPool& instance();
+
+    void submit(Job job, JobGroup* group = nullptr);
+
+    // run one pending job of `group` on the calling thread; false if none is queued
+    bool runOne(JobGroup* group);
+
+    int workerCount() const { return static_cast<int>(workers.size()); }
+
+    ~JobPool();
+
+private:
+    JobPool();
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    struct Task { Job job; JobGroup* group; };
+    struct Queue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::atomic<unsigned> nextQueue{0};
+    std::atomic<int> queued{0};
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    bool popOrSteal(int self, Task& out);
+    bool popGroup(JobGroup* group, Task& out);
+    void run(Task& t);
+    void workerLoop(int index);
+};
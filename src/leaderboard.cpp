@@ -0,0 +1,167 @@
+#include "leaderboard.h"
+
+// ---------- RankTree ----------
+
+void RankTree::clear()
+{
+    nodes.clear();
+    freeNodes.clear();
+    root = -1;
+}
+
+uint32_t RankTree::nextPrio()
+{
+    // xorshift32, đủ ngẫu nhiên cho độ cân bằng của treap
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+void RankTree::split(int32_t n, const Key& key, bool withKey, int32_t& l, int32_t& r)
+{
+    if (n < 0) {
+        l = r = -1;
+        return;
+    }
+    const bool goesLeft = withKey ? !(key < nodes[n].key) : nodes[n].key < key;
+    if (goesLeft) {
+        split(nodes[n].right, key, withKey, nodes[n].right, r);
+        l = n;
+    } else {
+        split(nodes[n].left, key, withKey, l, nodes[n].left);
+        r = n;
+    }
+    pull(n);
+}
+
+int32_t RankTree::merge(int32_t l, int32_t r)
+{
+    if (l < 0) return r;
+    if (r < 0) return l;
+    if (nodes[l].prio > nodes[r].prio) {
+        nodes[l].right = merge(nodes[l].right, r);
+        pull(l);
+        return l;
+    }
+    nodes[r].left = merge(l, nodes[r].left);
+    pull(r);
+    return r;
+}
+
+void RankTree::insert(const Key& key)
+{
+    int32_t n;
+    if (!freeNodes.empty()) {
+        n = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        n = static_cast<int32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+    nodes[n] = { key, nextPrio(), 1, -1, -1 };
+    int32_t l, r;
+    split(root, key, false, l, r);
+    root = merge(merge(l, n), r);
+}
+
+bool RankTree::erase(const Key& key)
+{
+    int32_t l, mid, r;
+    split(root, key, false, l, r);  // l < key <= r
+    split(r, key, true, mid, r);    // mid == key
+    if (mid >= 0) freeNodes.push_back(mid); // unique keys: one node at most
+    root = merge(l, r);
+    return mid >= 0;
+}
+
+size_t RankTree::rank(const Key& key) const
+{
+    size_t before = 0;
+    for (int32_t n = root; n >= 0;) {
+        if (nodes[n].key < key) {
+            before += sizeOf(nodes[n].left) + 1;
+            n = nodes[n].right;
+        } else {
+            n = nodes[n].left;
+        }
+    }
+    return before;
+}
+
+void RankTree::top(size_t k, std::vector<Key>& out) const
+{
+    out.clear();
+    std::vector<int32_t> stack;
+    int32_t n = root;
+    while ((n >= 0 || !stack.empty()) && out.size() < k) {
+        while (n >= 0) {
+            stack.push_back(n);
+            n = nodes[n].left;
+        }
+        n = stack.back();
+        stack.pop_back();
+        out.push_back(nodes[n].key);
+        n = nodes[n].right;
+    }
+}
+
+// ---------- Leaderboards ----------
+
+void Leaderboards::clear()
+{
+    stats.clear();
+    trees.clear();
+    names.clear();
+}
+
+void Leaderboards::setName(uint32_t id, const std::string& name)
+{
+    if (names.size() <= id) names.resize(id + 1);
+    names[id] = name;
+}
+
+void Leaderboards::set(uint32_t id, uint32_t stage, const LevelStats& s)
+{
+    RankTree& tree = trees[stage];
+    LevelStats& cur = stats[keyOf(id, stage)];
+    if (cur.cleared()) tree.erase({ cur.bestMoves, cur.bestTimeMs, id });
+    cur = s;
+    if (cur.cleared()) tree.insert({ cur.bestMoves, cur.bestTimeMs, id });
+}
+
+LevelStats Leaderboards::get(uint32_t id, uint32_t stage) const
+{
+    auto it = stats.find(keyOf(id, stage));
+    return it != stats.end() ? it->second : LevelStats();
+}
+
+size_t Leaderboards::rank(uint32_t id, uint32_t stage) const
+{
+    const LevelStats s = get(id, stage);
+    auto it = trees.find(stage);
+    if (!s.cleared() || it == trees.end()) return 0;
+    return it->second.rank({ s.bestMoves, s.bestTimeMs, id }) + 1;
+}
+
+size_t Leaderboards::ranked(uint32_t stage) const
+{
+    auto it = trees.find(stage);
+    return it != trees.end() ? it->second.size() : 0;
+}
+
+void Leaderboards::top(uint32_t stage, size_t k, std::vector<Standing>& out) const
+{
+    out.clear();
+    auto it = trees.find(stage);
+    if (it == trees.end()) return;
+    std::vector<RankTree::Key> keys;
+    it->second.top(k, keys);
+    for (const RankTree::Key& key : keys) {
+        Standing s;
+        if (key.id < names.size()) s.username = names[key.id];
+        s.moves = key.moves;
+        s.timeMs = key.timeMs;
+        out.push_back(std::move(s));
+    }
+}
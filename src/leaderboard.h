@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Results of one account on one level (StageInfo::id, not the catalog index)
+struct LevelStats {
+    uint32_t bestMoves = 0;  // 0 = never cleared
+    uint32_t bestTimeMs = 0;
+    uint32_t attempts = 0;   // finished runs, won or lost
+    bool cleared() const { return bestMoves != 0; }
+};
+
+// Order-statistic treap: keys stay sorted and every node knows the size of its subtree,
+// so insert, erase and the rank of a key are O(log n) and the first k keys O(log n + k).
+// Nodes live in one vector, linked by index; erased nodes are reused.
+class RankTree {
+public:
+    struct Key {
+        uint32_t moves;
+        uint32_t timeMs;
+        uint32_t id; // ties broken by account id, so keys are unique
+        bool operator<(const Key& o) const
+        {
+            if (moves != o.moves) return moves < o.moves;
+            if (timeMs != o.timeMs) return timeMs < o.timeMs;
+            return id < o.id;
+        }
+    };
+
+    void clear();
+    void insert(const Key& key);
+    bool erase(const Key& key);
+    // number of keys before `key`
+    size_t rank(const Key& key) const;
+    // the first k keys in order
+    void top(size_t k, std::vector<Key>& out) const;
+    size_t size() const { return sizeOf(root); }
+
+private:
+    struct Node {
+        Key key;
+        uint32_t prio;
+        uint32_t size;
+        int32_t left;
+        int32_t right;
+    };
+    std::vector<Node> nodes;
+    std::vector<int32_t> freeNodes;
+    int32_t root = -1;
+    uint32_t seed = 0x9E3779B9u;
+
+    uint32_t nextPrio();
+    uint32_t sizeOf(int32_t n) const { return n < 0 ? 0 : nodes[n].size; }
+    void pull(int32_t n) { nodes[n].size = 1 + sizeOf(nodes[n].left) + sizeOf(nodes[n].right); }
+    // l gets the keys before `key` (and `key` itself when withKey), r the rest
+    void split(int32_t n, const Key& key, bool withKey, int32_t& l, int32_t& r);
+    int32_t merge(int32_t l, int32_t r);
+};
+
+// Per-level stats of every account plus one RankTree per level ordered by
+// (best moves, best time), for "top k" and "my rank" on the victory screen.
+class Leaderboards {
+public:
+    struct Standing {
+        std::string username;
+        uint32_t moves = 0;
+        uint32_t timeMs = 0;
+    };
+
+    void clear();
+    void setName(uint32_t id, const std::string& name);
+    // replace the stats of (account id, stage id); the level's tree follows
+    void set(uint32_t id, uint32_t stage, const LevelStats& s);
+    LevelStats get(uint32_t id, uint32_t stage) const;
+    // 1 = best, 0 = not cleared
+    size_t rank(uint32_t id, uint32_t stage) const;
+    // accounts that cleared the level
+    size_t ranked(uint32_t stage) const;
+    void top(uint32_t stage, size_t k, std::vector<Standing>& out) const;
+
+private:
+    static uint64_t keyOf(uint32_t id, uint32_t stage) { return (static_cast<uint64_t>(id) << 32) | stage; }
+    std::unordered_map<uint64_t, LevelStats> stats;
+    std::unordered_map<uint32_t, RankTree> trees; // by stage id (ids are not dense)
+    std::vector<std::string> names; // by account id
+};
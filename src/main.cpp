@@ -3,36 +3,82 @@
 #include "game.h"
 #include "start.h"
 #include "audio.h"
+#include "assets.h"
+#include "catalog.h"
+#include "scene.h"
+#include "userstore.h"
+#include "replay.h"
 extern Audio* g_audioInstance = nullptr;
 
 int main(int argc, char** argv) {
+    const Uint64 launchNs = SDL_GetTicksNS(); // mốc cho time-to-first-frame
     SDL_Window* window = nullptr;
     SDL_Init(SDL_INIT_VIDEO);
     TTF_Init();
-    // Khởi tạo audio nếu chưa có (để nhạc nền tiếp tục phát)
-    if (!g_audioInstance) {
-        SDL_Init(SDL_INIT_AUDIO);
-        g_audioInstance = new Audio();
-        if (g_audioInstance->init()) {
-            // Load và phát nhạc nền
-            if (g_audioInstance->loadBackgroundMusic("assets/audio/background_music.wav")) {
-                g_audioInstance->playBackgroundMusic(true); // Loop
+    Assets::init(); // map assets.pak once; loose files if it is missing
+    StageCatalog::load();
+    // Audio chỉ được tạo ở đây; device, bank hiệu ứng và nhạc nền mở trên thread riêng
+    // sau frame đầu tiên (scene nào gọi playMusic trước đó thì được phát khi xong, có fade-in)
+    if (!g_audioInstance) g_audioInstance = new Audio();
+    window = SDL_CreateWindow("Mê Cung Tây Du", 1920, 911, SDL_WINDOW_RESIZABLE);
+    SDL_MaximizeWindow(window);
+    {
+        // một renderer và một vòng lặp cho cả chương trình; menu <-> game chỉ là push/pop
+        SceneManager scenes;
+        scenes.setFrameCallback([launchNs](uint64_t frame) {
+            if (frame == 1) {
+                std::cerr << "main - time to first frame: " << (SDL_GetTicksNS() - launchNs) / 1e6 << " ms\n";
+                if (g_audioInstance) g_audioInstance->initAsync(2000);
+            }
+            if (g_audioInstance) g_audioInstance->poll();
+        });
+        if (scenes.init(window)) {
+            // MUMMYMAZE_CAPTURE=png|y4m: ghi lại mọi frame vào captures/ (y4m nếu giá trị lạ)
+            // MUMMYMAZE_EXPORT=<file .mmr>: phát lại replay và xuất ra captures/export nhanh hết mức encoder cho phép
+            const char* captureEnv = SDL_getenv("MUMMYMAZE_CAPTURE");
+            const char* exportEnv = SDL_getenv("MUMMYMAZE_EXPORT");
+            FrameCapture::Format format = FrameCapture::Format::Y4m;
+            if (captureEnv && captureEnv[0] && !FrameCapture::parseFormat(captureEnv, format))
+                std::cerr << "main - unknown MUMMYMAZE_CAPTURE '" << captureEnv << "', using y4m\n";
+
+            Replay replay;
+            bool exporting = false;
+            if (exportEnv && exportEnv[0] && replay.load(exportEnv)) {
+                if (static_cast<int>(replay.stage) < StageCatalog::count() &&
+                    StageCatalog::get(static_cast<int>(replay.stage)).id == replay.stageId) {
+                    exporting = true;
+                } else {
+                    std::cerr << "main - replay " << exportEnv << " is for stage " << replay.stageId
+                              << ", which is not in the catalog at index " << replay.stage << "\n";
+                }
+            }
+
+            if (exporting) {
+                // mỗi tick simulation một frame, không chờ 16 ms giữa các frame
+                scenes.getCapture().start(scenes.getRenderer(), "captures/export", format, Game::simHz(), true);
+                scenes.setThrottle(false);
+                auto game = std::make_unique<Game>();
+                game->setPlayback(std::move(replay));
+                scenes.push(std::move(game));
             } else {
-                std::cerr << "Failed to load background music\n";
+                if (captureEnv && captureEnv[0])
+                    scenes.getCapture().start(scenes.getRenderer(), "captures", format, 60, false);
+                scenes.push(std::make_unique<Start>());
             }
+            scenes.run();
         }
+        scenes.cleanup();
     }
-    window = SDL_CreateWindow("Mê Cung Tây Du", 1920, 911, SDL_WINDOW_RESIZABLE);
-    SDL_MaximizeWindow(window);
-    Start start;
-    start.run(window);
-    SDL_DestroyWindow(window); 
+    // tiến độ / đăng xuất còn chờ writer thread thì ghi nốt trước khi thoát
+    UserStore::shutdownAll();
+    SDL_DestroyWindow(window);
     window = nullptr;
     if (g_audioInstance) {
         g_audioInstance->cleanup();
         delete g_audioInstance;
         g_audioInstance = nullptr;
     }
+    Assets::shutdown();
     SDL_Quit();
     TTF_Quit();
     return 0;
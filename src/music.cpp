@@ -0,0 +1,263 @@
+#include "music.h"
+#include "assets.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+const Uint16 WAVE_PCM = 0x0001;
+const Uint16 WAVE_IMA_ADPCM = 0x0011;
+const Uint16 WAVE_EXTENSIBLE = 0xFFFE;
+const int PCM_CHUNK_FRAMES = 2048;
+
+const int IMA_INDEX[16] = { -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8 };
+const int IMA_STEP[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+inline Sint16 imaDecode(int nibble, int& predictor, int& index)
+{
+    const int step = IMA_STEP[index];
+    int diff = step >> 3;
+    if (nibble & 4) diff += step;
+    if (nibble & 2) diff += step >> 1;
+    if (nibble & 1) diff += step >> 2;
+    predictor += (nibble & 8) ? -diff : diff;
+    predictor = std::clamp(predictor, -32768, 32767);
+    index = std::clamp(index + IMA_INDEX[nibble], 0, 88);
+    return static_cast<Sint16>(predictor);
+}
+}
+
+MusicStream::~MusicStream()
+{
+    if (converter) SDL_DestroyAudioStream(converter);
+    if (io) SDL_CloseIO(io);
+}
+
+bool MusicStream::open(const std::string& p, const SDL_AudioSpec& mixSpec, bool looping)
+{
+    path = p;
+    loop = looping;
+    io = Assets::open(path);
+    if (!io) {
+        std::cerr << "MusicStream::open - cannot open " << path << "\n";
+        return false;
+    }
+
+    char id[4];
+    Uint32 size = 0;
+    if (SDL_ReadIO(io, id, 4) != 4 || std::memcmp(id, "RIFF", 4) != 0 || !SDL_ReadU32LE(io, &size) ||
+        SDL_ReadIO(io, id, 4) != 4 || std::memcmp(id, "WAVE", 4) != 0) {
+        std::cerr << "MusicStream::open - " << path << " is not a WAV file\n";
+        return false;
+    }
+
+    // duyệt các chunk tới "data"; fmt và fact có thể nằm ở bất kỳ đâu trước nó
+    Uint16 format = 0, bits = 0;
+    Uint32 rate = 0;
+    bool haveFmt = false;
+    while (SDL_ReadIO(io, id, 4) == 4 && SDL_ReadU32LE(io, &size)) {
+        const Sint64 next = SDL_TellIO(io) + size + (size & 1);
+        if (std::memcmp(id, "fmt ", 4) == 0 && size >= 16) {
+            Uint16 ch = 0, align = 0;
+            Uint32 byteRate = 0;
+            SDL_ReadU16LE(io, &format);
+            SDL_ReadU16LE(io, &ch);
+            SDL_ReadU32LE(io, &rate);
+            SDL_ReadU32LE(io, &byteRate);
+            SDL_ReadU16LE(io, &align);
+            SDL_ReadU16LE(io, &bits);
+            channels = ch;
+            blockAlign = align;
+            if (size >= 20) {
+                Uint16 extra = 0, spb = 0;
+                SDL_ReadU16LE(io, &extra);
+                SDL_ReadU16LE(io, &spb);
+                samplesPerBlock = spb; // ADPCM: samples per block; EXTENSIBLE: valid bits
+            }
+            if (format == WAVE_EXTENSIBLE && size >= 40) {
+                Uint32 mask = 0;
+                Uint16 sub = 0;
+                SDL_ReadU32LE(io, &mask);
+                SDL_ReadU16LE(io, &sub); // first two bytes of the sub-format GUID
+                format = sub;
+            }
+            haveFmt = true;
+        } else if (std::memcmp(id, "fact", 4) == 0 && size >= 4) {
+            SDL_ReadU32LE(io, &totalFrames);
+        } else if (std::memcmp(id, "data", 4) == 0) {
+            dataStart = SDL_TellIO(io);
+            dataSize = size;
+            break;
+        }
+        if (SDL_SeekIO(io, next, SDL_IO_SEEK_SET) < 0) break;
+    }
+
+    if (!haveFmt || dataStart == 0 || channels < 1 || channels > 2 || rate == 0) {
+        std::cerr << "MusicStream::open - " << path << " has no usable fmt/data chunk\n";
+        return false;
+    }
+    if (format == WAVE_PCM && bits == 16) {
+        codec = Codec::Pcm16;
+        blockAlign = 2 * channels;
+    } else if (format == WAVE_IMA_ADPCM && bits == 4 && blockAlign > 4 * channels) {
+        codec = Codec::ImaAdpcm;
+        const int computed = (blockAlign - 4 * channels) * 2 / channels + 1;
+        if (samplesPerBlock <= 0 || samplesPerBlock > computed) samplesPerBlock = computed;
+    } else {
+        std::cerr << "MusicStream::open - " << path << ": format " << format << "/" << bits
+                  << " bit not supported (16-bit PCM or IMA-ADPCM)\n";
+        return false;
+    }
+
+    const SDL_AudioSpec src = { SDL_AUDIO_S16LE, channels, static_cast<int>(rate) };
+    converter = SDL_CreateAudioStream(&src, &mixSpec);
+    if (!converter) {
+        std::cerr << "MusicStream::open - converter failed: " << SDL_GetError() << "\n";
+        return false;
+    }
+    mixChannels = mixSpec.channels;
+    const int chunkFrames = codec == Codec::Pcm16 ? PCM_CHUNK_FRAMES : samplesPerBlock;
+    block.resize(codec == Codec::Pcm16 ? static_cast<size_t>(PCM_CHUNK_FRAMES) * blockAlign : blockAlign);
+    pcm.resize(static_cast<size_t>(chunkFrames) * channels);
+    converted.resize(static_cast<size_t>(PCM_CHUNK_FRAMES) * mixChannels);
+    ring.assign(static_cast<size_t>(RING_FRAMES) * mixChannels, 0.0f);
+    return true;
+}
+
+bool MusicStream::decodeChunk()
+{
+    if (dataRead >= dataSize || (totalFrames && framesDecoded >= totalFrames)) {
+        if (!loop) return false;
+        // vòng lặp liền mạch: quay về block đầu, converter giữ nguyên phần đang dở
+        if (SDL_SeekIO(io, dataStart, SDL_IO_SEEK_SET) < 0) return false;
+        dataRead = 0;
+        framesDecoded = 0;
+    }
+
+    const Uint32 want = std::min<Uint32>(static_cast<Uint32>(block.size()), dataSize - dataRead);
+    const size_t got = SDL_ReadIO(io, block.data(), want);
+    if (got == 0) {
+        dataRead = dataSize; // file ngắn hơn header báo
+        return loop && framesDecoded > 0;
+    }
+    dataRead += static_cast<Uint32>(got);
+
+    int frames = 0;
+    if (codec == Codec::Pcm16) {
+        frames = static_cast<int>(got) / blockAlign;
+        std::memcpy(pcm.data(), block.data(), static_cast<size_t>(frames) * blockAlign);
+    } else {
+        if (got <= static_cast<size_t>(4 * channels)) return true;
+        frames = std::min<int>(samplesPerBlock, (static_cast<int>(got) - 4 * channels) * 2 / channels + 1);
+        decodeAdpcmBlock(block.data(), static_cast<int>(got), frames, pcm.data());
+    }
+    if (totalFrames && framesDecoded + frames > totalFrames)
+        frames = static_cast<int>(totalFrames - framesDecoded); // bỏ phần đệm của block cuối
+    framesDecoded += frames;
+    if (frames > 0) SDL_PutAudioStreamData(converter, pcm.data(), frames * channels * 2);
+    return true;
+}
+
+void MusicStream::decodeAdpcmBlock(const Uint8* src, int size, int frames, Sint16* out) const
+{
+    int predictor[2] = { 0, 0 };
+    int index[2] = { 0, 0 };
+    for (int c = 0; c < channels; ++c) {
+        predictor[c] = static_cast<Sint16>(src[4 * c] | (src[4 * c + 1] << 8));
+        index[c] = std::clamp<int>(src[4 * c + 2], 0, 88);
+        out[c] = static_cast<Sint16>(predictor[c]);
+    }
+
+    // sau header: mỗi kênh lần lượt 4 byte = 8 mẫu, nibble thấp trước
+    const Uint8* p = src + 4 * channels;
+    const Uint8* end = src + size;
+    int frame = 1;
+    while (frame < frames && p + 4 * channels <= end) {
+        for (int c = 0; c < channels; ++c) {
+            for (int i = 0; i < 8; ++i) {
+                const int nibble = (p[i >> 1] >> ((i & 1) * 4)) & 0xF;
+                const Sint16 s = imaDecode(nibble, predictor[c], index[c]);
+                if (frame + i < frames) out[(frame + i) * channels + c] = s;
+            }
+            p += 4;
+        }
+        frame += 8;
+    }
+    for (; frame < frames; ++frame) // block cụt: lặp mẫu cuối thay vì để rác
+        for (int c = 0; c < channels; ++c) out[frame * channels + c] = static_cast<Sint16>(predictor[c]);
+}
+
+bool MusicStream::fill()
+{
+    if (!converter || ended.load(std::memory_order_relaxed)) return false;
+    const int frameBytes = static_cast<int>(sizeof(float)) * mixChannels;
+    const int maxConverted = static_cast<int>(converted.size()) / mixChannels;
+    bool worked = false;
+    for (;;) {
+        const size_t space = RING_FRAMES - (writePos.load(std::memory_order_relaxed) -
+                                            readPos.load(std::memory_order_acquire));
+        const int available = SDL_GetAudioStreamAvailable(converter) / frameBytes;
+        if (available > 0) {
+            if (space == 0) break;
+            const int want = std::min<int>({ available, static_cast<int>(space), maxConverted });
+            const int got = SDL_GetAudioStreamData(converter, converted.data(), want * frameBytes) / frameBytes;
+            if (got <= 0) break;
+            const size_t w = writePos.load(std::memory_order_relaxed);
+            const size_t at = w % RING_FRAMES;
+            const size_t first = std::min<size_t>(static_cast<size_t>(got), RING_FRAMES - at);
+            std::memcpy(ring.data() + at * mixChannels, converted.data(), first * frameBytes);
+            if (first < static_cast<size_t>(got))
+                std::memcpy(ring.data(), converted.data() + first * mixChannels, (got - first) * frameBytes);
+            writePos.store(w + got, std::memory_order_release);
+            worked = true;
+            continue;
+        }
+        if (sourceDone) {
+            ended.store(true, std::memory_order_release);
+            break;
+        }
+        // giải mã thêm chỉ khi ring còn chỗ cho cả chunk, converter không phình ra
+        if (space < static_cast<size_t>(maxConverted)) break;
+        if (!decodeChunk()) {
+            SDL_FlushAudioStream(converter);
+            sourceDone = true;
+        }
+        worked = true;
+    }
+    return worked;
+}
+
+int MusicStream::readable(int frames, const float*& a, int& na, const float*& b, int& nb) const
+{
+    const size_t r = readPos.load(std::memory_order_relaxed);
+    const size_t ready = writePos.load(std::memory_order_acquire) - r;
+    const int n = static_cast<int>(std::min<size_t>(ready, static_cast<size_t>(frames)));
+    const size_t at = r % RING_FRAMES;
+    na = static_cast<int>(std::min<size_t>(static_cast<size_t>(n), RING_FRAMES - at));
+    nb = n - na;
+    a = ring.data() + at * mixChannels;
+    b = ring.data();
+    return n;
+}
+
+void MusicStream::consume(int frames)
+{
+    readPos.store(readPos.load(std::memory_order_relaxed) + frames, std::memory_order_release);
+}
+
+bool MusicStream::finished() const
+{
+    return ended.load(std::memory_order_acquire) &&
+           readPos.load(std::memory_order_relaxed) == writePos.load(std::memory_order_acquire);
+}
+
+size_t MusicStream::residentBytes() const
+{
+    return ring.size() * sizeof(float) + converted.size() * sizeof(float) + block.size() + pcm.size() * sizeof(Sint16);
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+// One music track streamed from a WAV file (16-bit PCM or IMA-ADPCM, mono or stereo;
+// tools/wav_adpcm.cpp makes the ADPCM ones, about 4x smaller than PCM).
+// The Audio music thread decodes it a block at a time, converts it to the mixer format
+// and keeps at most RING_FRAMES ready frames ahead of the audio callback, so only a few
+// tens of kilobytes are resident whatever the track length. Looping seeks back to the
+// first data block without flushing the converter, so the loop point has no gap.
+//
+// Threads: open() on the caller, fill() on the music thread only, readable()/consume()
+// on the audio callback only; the ring between them is lock-free.
+class MusicStream {
+public:
+    static const int RING_FRAMES = 8192;
+
+    MusicStream() = default;
+    ~MusicStream();
+    MusicStream(const MusicStream&) = delete;
+    MusicStream& operator=(const MusicStream&) = delete;
+
+    // parse the header; false if the file is missing or its format is not supported
+    bool open(const std::string& path, const SDL_AudioSpec& mixSpec, bool loop);
+    const std::string& getPath() const { return path; }
+
+    // decode until the ring is full or the track ended; true if anything was done
+    bool fill();
+
+    // up to `frames` ready frames as (at most) two contiguous spans; returns the total
+    int readable(int frames, const float*& a, int& na, const float*& b, int& nb) const;
+    void consume(int frames);
+    // not looping, decoded to the end and everything consumed
+    bool finished() const;
+
+    size_t residentBytes() const;
+
+    // set by the audio callback once it will never read this stream again
+    std::atomic<bool> released{ false };
+
+private:
+    enum class Codec { Pcm16, ImaAdpcm };
+
+    std::string path;
+    SDL_IOStream* io = nullptr;
+    SDL_AudioStream* converter = nullptr; // source format -> mixer format
+    Codec codec = Codec::Pcm16;
+    int channels = 0;
+    int mixChannels = 0;
+    int blockAlign = 0;       // bytes per frame (PCM) or per ADPCM block
+    int samplesPerBlock = 0;  // ADPCM
+    Sint64 dataStart = 0;
+    Uint32 dataSize = 0;
+    Uint32 dataRead = 0;
+    Uint32 totalFrames = 0;   // from the "fact" chunk, 0 = unknown
+    Uint32 framesDecoded = 0; // in the current pass over the data
+    bool loop = true;
+    bool sourceDone = false;  // non-looping track fully decoded and flushed
+
+    std::vector<Uint8> block;
+    std::vector<Sint16> pcm;
+    std::vector<float> converted;
+
+    std::vector<float> ring;
+    std::atomic<size_t> writePos{ 0 }; // frames, music thread
+    std::atomic<size_t> readPos{ 0 };  // frames, audio callback
+    std::atomic<bool> ended{ false };
+
+    // decode one chunk into the converter; false at the end of a non-looping track
+    bool decodeChunk();
+    void decodeAdpcmBlock(const Uint8* src, int size, int frames, Sint16* out) const;
+};
@@ -0,0 +1,97 @@
+#include "replay.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+
+void putU32(std::string& o, uint32_t v) { o.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+void putI32(std::string& o, int32_t v) { o.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+void putU16(std::string& o, uint16_t v) { o.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+
+template <typename T>
+bool get(const std::string& s, size_t& pos, T& v)
+{
+    if (pos + sizeof(T) > s.size()) return false;
+    std::memcpy(&v, s.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+const size_t EVENT_BYTES = 4 + 1 + 4 + 4 + 2 + 1 + 4 + 4;
+
+} // namespace
+
+void Replay::clear()
+{
+    stage = 0;
+    stageId = 0;
+    ticks = 0;
+    events.clear();
+}
+
+bool Replay::save(const std::string& path) const
+{
+    std::string out;
+    out.reserve(24 + events.size() * EVENT_BYTES);
+    out.append("MMRP", 4);
+    putU32(out, VERSION);
+    putU32(out, stage);
+    putI32(out, stageId);
+    putU32(out, ticks);
+    putU32(out, static_cast<uint32_t>(events.size()));
+    for (const Event& e : events) {
+        putU32(out, e.tick);
+        out.push_back(static_cast<char>(e.kind));
+        putI32(out, e.key);
+        putI32(out, e.scancode);
+        putU16(out, e.mod);
+        out.push_back(static_cast<char>(e.repeat));
+        putI32(out, e.tx);
+        putI32(out, e.ty);
+    }
+
+    std::error_code ec;
+    const std::filesystem::path p(path);
+    if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path(), ec);
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    if (!ofs || !ofs.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+        std::cerr << "Replay::save - cannot write " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool Replay::load(const std::string& path)
+{
+    clear();
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        std::cerr << "Replay::load - cannot open " << path << "\n";
+        return false;
+    }
+    const std::string data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    size_t pos = 4;
+    uint32_t version = 0, count = 0;
+    if (data.compare(0, 4, "MMRP") != 0 || !get(data, pos, version) || version != VERSION ||
+        !get(data, pos, stage) || !get(data, pos, stageId) || !get(data, pos, ticks) || !get(data, pos, count) ||
+        count > (data.size() - pos) / EVENT_BYTES) {
+        std::cerr << "Replay::load - " << path << " is damaged or not a version " << VERSION << " replay\n";
+        clear();
+        return false;
+    }
+    events.resize(count);
+    for (Event& e : events) {
+        get(data, pos, e.tick);
+        get(data, pos, e.kind);
+        get(data, pos, e.key);
+        get(data, pos, e.scancode);
+        get(data, pos, e.mod);
+        get(data, pos, e.repeat);
+        get(data, pos, e.tx);
+        get(data, pos, e.ty);
+    }
+    return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Input of one run of a level, keyed by simulation tick. The simulation only advances
+// per tick (tweens, turns, mummy moves), so feeding the same commands at the same
+// ticks plays the run again exactly, whatever the frame rate it was recorded at.
+// Only commands that change the run are kept (Hover just draws the path preview).
+//   "MMRP", u32 version, u32 stage index, i32 stage id, u32 ticks, u32 count,
+//   count x { u32 tick, u8 kind, i32 key, i32 scancode, u16 mod, u8 repeat, i32 tx, i32 ty }
+struct Replay {
+    struct Event {
+        uint32_t tick = 0;
+        uint8_t kind = 0;   // Game::SimCommand::Kind
+        int32_t key = 0;    // Key: the SDL_KeyboardEvent fields input handlers may read
+        int32_t scancode = 0;
+        uint16_t mod = 0;
+        uint8_t repeat = 0;
+        int32_t tx = -1, ty = -1; // Click tile
+    };
+
+    static const uint32_t VERSION = 2; // 1: keycode only
+
+    uint32_t stage = 0;  // StageCatalog index
+    int32_t stageId = 0; // StageInfo::id, checked on load so a reordered catalog is noticed
+    uint32_t ticks = 0;  // ticks until the run ended
+    std::vector<Event> events;
+
+    void clear();
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+};
@@ -0,0 +1,135 @@
+#include "scene.h"
+#include "assets.h"
+#include <iostream>
+
+SceneManager::~SceneManager() { cleanup(); }
+
+bool SceneManager::init(SDL_Window* win)
+{
+    window = win;
+    renderer = SDL_CreateRenderer(window, NULL);
+    if (!renderer) {
+        std::cerr << "SceneManager::init - SDL_CreateRenderer failed | " << SDL_GetError() << "\n";
+        return false;
+    }
+    return true;
+}
+
+void SceneManager::cleanup()
+{
+    requests.clear();
+    while (!stack.empty()) exitTop();
+    capture.stop();
+    Assets::clearTextures();
+    if (renderer) { SDL_DestroyRenderer(renderer); renderer = nullptr; }
+    running = false;
+}
+
+void SceneManager::push(std::unique_ptr<Scene> scene)
+{
+    if (!scene) return;
+    requests.push_back({ Request::Kind::Push, std::move(scene) });
+}
+
+void SceneManager::pop()
+{
+    requests.push_back({ Request::Kind::Pop, nullptr });
+}
+
+void SceneManager::replace(std::unique_ptr<Scene> scene)
+{
+    if (!scene) return;
+    requests.push_back({ Request::Kind::Replace, std::move(scene) });
+}
+
+void SceneManager::enterScene(std::unique_ptr<Scene> scene)
+{
+    if (!scene->enter(this)) {
+        std::cerr << "SceneManager - scene failed to start, dropped\n";
+        scene->exit();
+        return;
+    }
+    stack.push_back(std::move(scene));
+}
+
+void SceneManager::exitTop()
+{
+    std::unique_ptr<Scene> top = std::move(stack.back());
+    stack.pop_back();
+    top->exit();
+}
+
+void SceneManager::applyRequests()
+{
+    // a scene's enter()/exit() may queue more requests; take them in order until none are left
+    while (!requests.empty()) {
+        std::vector<Request> batch;
+        batch.swap(requests);
+        for (Request& r : batch) {
+            switch (r.kind) {
+            case Request::Kind::Push:
+                enterScene(std::move(r.scene));
+                break;
+            case Request::Kind::Pop:
+                if (stack.empty()) break;
+                exitTop();
+                Assets::trimTextures();
+                if (!stack.empty()) stack.back()->resume();
+                break;
+            case Request::Kind::Replace:
+                if (!stack.empty()) exitTop();
+                // texture cũ còn giữ tới khi scene mới lấy xong, thứ dùng chung không phải tải lại
+                enterScene(std::move(r.scene));
+                Assets::trimTextures();
+                break;
+            }
+        }
+    }
+}
+
+void SceneManager::handleResize(const SDL_Event& e)
+{
+    // giữ tỉ lệ khung hình của màn logic, scale renderer theo chiều rộng
+    const float windowRatio = static_cast<float>(LOGICAL_W) / static_cast<float>(LOGICAL_H);
+    int w = e.window.data1;
+    int h = e.window.data2;
+    if (w != curW)
+        h = static_cast<int>(w / windowRatio);
+    else if (h != curH)
+        w = static_cast<int>(h * windowRatio);
+    SDL_SetWindowSize(window, w, h);
+    float scale = static_cast<float>(w) / static_cast<float>(LOGICAL_W);
+    SDL_SetRenderScale(renderer, scale, scale);
+    curW = w;
+    curH = h;
+}
+
+void SceneManager::run()
+{
+    if (!renderer) return;
+    applyRequests();
+    running = !stack.empty();
+    while (running) {
+        events.clear();
+        SDL_Event e;
+        while (SDL_PollEvent(&e)) {
+            if (e.type == SDL_EVENT_QUIT) running = false;
+            if (e.type == SDL_EVENT_WINDOW_RESIZED) handleResize(e);
+            events.push_back(e);
+        }
+        if (!running) break;
+
+        Scene* top = stack.back().get();
+        top->handleEvents(events);
+        top->update();
+        top->render();
+        if (capture.isActive()) capture.grab();
+        SDL_RenderPresent(renderer);
+        ++frameCount;
+        if (onFrame) onFrame(frameCount);
+
+        applyRequests();
+        if (stack.empty()) running = false;
+        if (throttle) SDL_Delay(16); // ~60 FPS
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "capture.h"
+
+class SceneManager;
+
+// One screen of the game (menu, level...).
+// A scene builds its UI in enter() with the manager's renderer and frees it in exit();
+// it never creates or destroys the renderer and never runs a loop of its own.
+class Scene {
+public:
+    virtual ~Scene() {}
+
+    // pushed on the stack; false = could not start, the scene is dropped again
+    virtual bool enter(SceneManager* scenes) = 0;
+    // about to be destroyed (popped or replaced)
+    virtual void exit() = 0;
+    // the scene above was popped and this one is on top again
+    virtual void resume() {}
+
+    // all events of this frame, in order (quit and window resize are handled by the manager)
+    virtual void handleEvents(const std::vector<SDL_Event>& events) = 0;
+    virtual void update() {}
+    // draw only; the manager clears nothing and presents after it
+    virtual void render() = 0;
+};
+
+// Owns the renderer and the only main loop.
+// Only the top scene gets events, updates and renders. push/pop/replace may be called
+// from anywhere inside a frame (button callbacks included): they are queued and applied
+// after the frame is presented, so a scene is never destroyed while its own code runs.
+// After a pop the shared texture cache is trimmed (Assets::trimTextures), so going
+// menu -> game -> menu returns to the same memory footprint while textures both
+// screens use (button skins, panels) are never uploaded twice.
+class SceneManager {
+public:
+    // logical size all screens lay out in; the render scale maps it to the window
+    static const int LOGICAL_W = 1920;
+    static const int LOGICAL_H = 991;
+
+    SceneManager() = default;
+    ~SceneManager();
+    SceneManager(const SceneManager&) = delete;
+    SceneManager& operator=(const SceneManager&) = delete;
+
+    // create the renderer for `window`; false on failure
+    bool init(SDL_Window* window);
+    // exit every scene, drop the shared textures and destroy the renderer
+    void cleanup();
+
+    // blocking; returns on SDL_EVENT_QUIT, quit() or when the last scene is popped
+    void run();
+
+    void push(std::unique_ptr<Scene> scene);
+    void pop();
+    void replace(std::unique_ptr<Scene> scene);
+    void quit() { running = false; }
+
+    // called after every presented frame with its number (1 = the first frame the
+    // player sees); work that must not delay the window hangs off frame 1
+    void setFrameCallback(std::function<void(uint64_t)> cb) { onFrame = std::move(cb); }
+
+    // frame capture: grabs every frame between render and present while active
+    FrameCapture& getCapture() { return capture; }
+    // false: no ~60 FPS delay between frames (replay export runs as fast as it can encode)
+    void setThrottle(bool on) { throttle = on; }
+
+    SDL_Window* getWindow() const { return window; }
+    SDL_Renderer* getRenderer() const { return renderer; }
+    size_t depth() const { return stack.size(); }
+
+private:
+    struct Request {
+        enum class Kind { Push, Pop, Replace } kind;
+        std::unique_ptr<Scene> scene;
+    };
+
+    SDL_Window* window = nullptr;
+    SDL_Renderer* renderer = nullptr;
+    std::vector<std::unique_ptr<Scene>> stack;
+    std::vector<Request> requests;
+    std::vector<SDL_Event> events; // reused every frame
+    bool running = false;
+    uint64_t frameCount = 0;
+    std::function<void(uint64_t)> onFrame;
+    FrameCapture capture;
+    bool throttle = true;
+    int curW = LOGICAL_W;
+    int curH = LOGICAL_H;
+
+    void applyRequests();
+    void enterScene(std::unique_ptr<Scene> scene);
+    void exitTop();
+    void handleResize(const SDL_Event& e);
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free hand-over of whole state snapshots from one writer thread to one reader
+// thread. The writer fills its private slot and publish() swaps it with the shared
+// middle slot; the reader's latest() swaps the middle slot with its own when something
+// new was published. Neither side ever waits, the reader always sees a complete
+// snapshot, and intermediate snapshots the reader was too slow for are simply skipped.
+// Slots are reused, so members like std::vector keep their capacity between ticks.
+template <typename T>
+class TripleBuffer {
+public:
+    // writer side: the slot being filled
+    T& back() { return slots[backIndex]; }
+    void publish()
+    {
+        const uint8_t prev = middle.exchange(static_cast<uint8_t>(backIndex | FRESH), std::memory_order_acq_rel);
+        backIndex = prev & INDEX_MASK;
+    }
+
+    // reader side: newest published snapshot (the previous one if nothing new arrived)
+    const T& latest()
+    {
+        if (middle.load(std::memory_order_relaxed) & FRESH) {
+            const uint8_t prev = middle.exchange(frontIndex, std::memory_order_acq_rel);
+            frontIndex = prev & INDEX_MASK;
+        }
+        return slots[frontIndex];
+    }
+    bool hasFresh() const { return (middle.load(std::memory_order_relaxed) & FRESH) != 0; }
+
+    // both threads stopped: make every slot equal to `value`
+    void reset(const T& value)
+    {
+        for (T& s : slots) s = value;
+        backIndex = 0;
+        middle.store(1, std::memory_order_relaxed);
+        frontIndex = 2;
+    }
+
+private:
+    static const uint8_t INDEX_MASK = 0x3;
+    static const uint8_t FRESH = 0x4;
+
+    T slots[3];
+    uint8_t backIndex = 0;            // writer only
+    std::atomic<uint8_t> middle{ 1 }; // shared: index | FRESH
+    uint8_t frontIndex = 2;           // reader only
+};
+
+// Bounded single-producer / single-consumer ring (N must be a power of two).
+// push() fails when the ring is full instead of blocking.
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert((N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+public:
+    bool push(const T& item)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == N) return false;
+        items[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    bool pop(T& out)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        out = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    // only while neither side is running
+    void clear() { tail.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed); }
+
+private:
+    T items[N];
+    alignas(64) std::atomic<size_t> head{ 0 }; // producer
+    alignas(64) std::atomic<size_t> tail{ 0 }; // consumer
+};
@@ -1,11 +1,27 @@
 #include "stages.h"
+#include "imagecache.h"
+#include "jobs.h"
+#include "catalog.h"
+#include <algorithm>
 #include <iostream>
 #include <cmath>
+#include <cstdlib>
 
 Stages::Stages(SDL_Renderer* renderer) : renderer(renderer) {}
-Stages::~Stages() { /* ...cleanup... */ }
+Stages::~Stages()
+{
+    for (auto& kv : thumbs) releaseThumb(kv.second);
+    thumbs.clear();
+}
+
+void Stages::releaseThumb(Thumb& t)
+{
+    if (t.tex) SDL_DestroyTexture(t.tex);
+    t.tex = nullptr;
+    t.job.reset(); // an unfinished job frees its own surface
+}
 
-bool Stages::init(SDL_Renderer* rend, User* user_, int w, int h, std::function<void(char)> onSelectCb)
+bool Stages::init(SDL_Renderer* rend, User* user_, int w, int h, std::function<void(int)> onSelectCb)
 {
     if (!rend) return false;
     renderer = rend;
@@ -13,29 +29,25 @@ bool Stages::init(SDL_Renderer* rend, User* user_, int w, int h, std::function<v
     onSelect = std::move(onSelectCb);
     winW = w; winH = h;
 
-    // load three stage preview textures: assets/images/background/background1_1.png .. background3_1.png
-    for (int i = 0; i < 3; ++i) {
-        std::string path = "assets/images/background/background" +  std::to_string(i + 1) + ".png";
-        tex[i] = IMG_LoadTexture(renderer, path.c_str());
-        if (!tex[i]) {
-            std::cerr << "Stages::init - failed load " << path << " | " << SDL_GetError() << "\n";
-        }
-    }
+    // thumbnails are made at the center size (the bigger one) in output pixels; the side
+    // size is a ~10% shrink of the same texture. Nothing is decoded here: see pollThumbs.
+    int outW = 0, outH = 0;
+    float outScale = 1.0f;
+    if (SDL_GetCurrentRenderOutputSize(renderer, &outW, &outH) && outW > 0 && winW > 0)
+        outScale = static_cast<float>(outW) / static_cast<float>(winW);
+    thumbPxW = std::max(1, static_cast<int>(std::lround(centerW * outScale)));
+    thumbPxH = std::max(1, static_cast<int>(std::lround(centerH * outScale)));
+    count = StageCatalog::count();
+    // half the window plus one center-sized preview, in slots
+    visibleRadius = static_cast<int>(std::ceil((winW * 0.5f + centerW) / static_cast<float>(thumbW + gap)));
+    keepRadius = visibleRadius + 1;
 
     // prepare question mark text
     qmarkText.create(renderer, "assets/font.ttf", 72, "?", {255,255,255,255});
 
-    // Set selected stage dựa trên stage hiện tại của user
-    if (user) {
-        char stageChar = user->getStage();
-        if (stageChar >= '1' && stageChar <= '3') {
-            selected = static_cast<int>(stageChar - '1'); // '1' -> 0, '2' -> 1, '3' -> 2
-        } else {
-            selected = 0; // mặc định stage 1 nếu stage không hợp lệ
-        }
-    } else {
-        selected = 0; // không có user thì mặc định stage 1
-    }
+    // Set selected stage: the first stage the user has not cleared yet
+    selected = user ? std::min(std::max(user->getProgress(), 0), count - 1) : 0;
+    if (selected < 0) selected = 0;
     
     prevSelected = selected;
     slideAnim = 0.0f;
@@ -44,10 +56,54 @@ bool Stages::init(SDL_Renderer* rend, User* user_, int w, int h, std::function<v
     return true;
 }
 
+void Stages::requestThumb(int idx)
+{
+    if (idx < 0 || idx >= count || !isIndexUnlocked(idx)) return;
+    Thumb& t = thumbs[idx];
+    if (t.job) return;
+    t.path = StageCatalog::get(idx).art;
+    auto job = std::make_shared<ThumbJob>();
+    t.job = job;
+    std::string path = t.path;
+    int w = thumbPxW, h = thumbPxH;
+    JobPool::instance().submit([job, path, w, h]() {
+        job->surface.store(ImageCache::loadSurface(path, w, h));
+        job->done.store(true, std::memory_order_release);
+    });
+}
+
+void Stages::pollThumbs()
+{
+    // drop previews that scrolled far away, then make sure everything near is requested
+    for (auto it = thumbs.begin(); it != thumbs.end();) {
+        if (std::abs(it->first - selected) > keepRadius && std::abs(it->first - prevSelected) > keepRadius) {
+            releaseThumb(it->second);
+            it = thumbs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    // nearest first, so the center is decoded before the edges
+    for (int d = 0; d <= keepRadius; ++d) {
+        requestThumb(selected - d);
+        requestThumb(selected + d);
+    }
+
+    for (auto& kv : thumbs) {
+        Thumb& t = kv.second;
+        if (t.tex || !t.job || !t.job->done.load(std::memory_order_acquire)) continue;
+        if (SDL_Surface* s = t.job->surface.exchange(nullptr)) {
+            t.tex = SDL_CreateTextureFromSurface(renderer, s);
+            SDL_DestroySurface(s);
+        }
+        if (!t.tex) std::cerr << "Stages - failed to load thumbnail " << t.path << " | " << SDL_GetError() << "\n";
+    }
+}
+
 void Stages::startSlideTo(int newIndex)
 {
     if (newIndex < 0) newIndex = 0;
-    if (newIndex > 2) newIndex = 2;
+    if (newIndex > count - 1) newIndex = count - 1;
     if (newIndex == selected) return;
     prevSelected = selected;
     selected = newIndex;
@@ -61,12 +117,13 @@ void Stages::handleEvent(const SDL_Event& e)
     if (!renderer) return;
 
     if (e.type == SDL_EVENT_KEY_DOWN) {
+        if (e.key.key == SDLK_F3) drawList.toggleStats();
         if (e.key.key == SDLK_LEFT) {
             int target = selected - 1;
             if (target >= 0) startSlideTo(target);
         } else if (e.key.key == SDLK_RIGHT) {
             int target = selected + 1;
-            if (target <= 2) startSlideTo(target);
+            if (target < count) startSlideTo(target);
         }
         return;
     }
@@ -88,10 +145,7 @@ void Stages::handleEvent(const SDL_Event& e)
         SDL_FRect centerDst = computeDstForIndex(selected);
         if (mx >= centerDst.x && mx < centerDst.x + centerDst.w && my >= centerDst.y && my < centerDst.y + centerDst.h) {
             if (isIndexUnlocked(selected)) {
-                if (onSelect) {
-                    char s = static_cast<char>('1' + selected);
-                    onSelect(s);
-                }
+                if (onSelect) onSelect(selected);
             }
         }
     }
@@ -143,18 +197,7 @@ SDL_FRect Stages::computeDstForIndex(int idx, float extraShift) const
 bool Stages::isIndexUnlocked(int idx) const
 {
     if (!user) return false;
-    
-    char u = user->getStage(); // e.g. '0','1','2','3'
-    
-    // Stage 1 (idx 0) luôn unlock (dù chưa chơi hay đã chơi)
-    if (idx == 0) {
-        return true;
-    }
-    
-    // Stage 2 (idx 1) unlock nếu đã thắng stage 1 (stage >= '2')
-    // Stage 3 (idx 2) unlock nếu đã thắng stage 2 (stage >= '3')
-    char requiredStage = static_cast<char>('1' + idx); // idx 1 -> '2', idx 2 -> '3'
-    return u >= requiredStage;
+    return StageCatalog::isUnlocked(idx, user->getProgress());
 }
 
 void Stages::render()
@@ -162,41 +205,52 @@ void Stages::render()
     if (!renderer) return;
     // update animation progress
     update();
+    pollThumbs();
+
+    // layers of the carousel draw list: previews, then every rect/border, then "?" labels
+    enum { L_THUMB = 0, L_LINES, L_LABEL };
+    drawList.begin(renderer);
 
-    // draw three previews: loop i=0..2
-    for (int i = 0; i < 3; ++i) {
+    // draw only the previews that can be on screen around the (animated) selection
+    const int lo = std::max(0, std::min(selected, prevSelected) - visibleRadius);
+    const int hi = std::min(count - 1, std::max(selected, prevSelected) + visibleRadius);
+    for (int i = lo; i <= hi; ++i) {
         SDL_FRect dst = computeDstForIndex(i);
+        if (dst.x + dst.w < 0.0f || dst.x > static_cast<float>(winW)) continue;
+        auto it = thumbs.find(i);
+        SDL_Texture* tex = (it != thumbs.end()) ? it->second.tex : nullptr;
         // choose appearance
-        if (isIndexUnlocked(i)) {
-            SDL_RenderTexture(renderer, tex[i], nullptr, &dst);
+        if (isIndexUnlocked(i) && tex) {
+            drawList.sprite(L_THUMB, tex, dst);
+        } else if (isIndexUnlocked(i)) {
+            // placeholder until the thumbnail job finishes
+            drawList.fillRect(L_THUMB, dst, { 60, 52, 40, 255 });
         } else {
                 // locked: render box with "?" centered and border (double-render)
-                SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
-                SDL_RenderFillRect(renderer, &dst);
+                drawList.fillRect(L_THUMB, dst, { 30, 30, 30, 255 });
                 // double-render border: two offset rects
-                SDL_SetRenderDrawColor(renderer, 200, 200, 200, 255);
                 SDL_FRect r1 = dst; r1.x -= 2; r1.y -= 2; r1.w += 4; r1.h += 4;
-                SDL_RenderRect(renderer, &r1);
+                drawList.rect(L_LINES, r1, { 200, 200, 200, 255 });
                 SDL_FRect r2 = dst; r2.x += 2; r2.y += 2; r2.w -= 4; r2.h -= 4;
-                SDL_RenderRect(renderer, &r2);
+                drawList.rect(L_LINES, r2, { 200, 200, 200, 255 });
                 // render "?" text centered
                 int qx = static_cast<int>(dst.x + dst.w * 0.5f - qmarkText.getWidth() * 0.5f);
                 int qy = static_cast<int>(dst.y + dst.h * 0.5f - qmarkText.getHeight() * 0.5f);
                 qmarkText.setPosition(qx, qy);
-                qmarkText.render();
+                drawList.text(L_LABEL, qmarkText);
             }
         // draw a subtle border for all thumbnails (double render)
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 200);
         SDL_FRect border1 = dst; border1.x -= 1; border1.y -= 1; border1.w += 2; border1.h += 2;
-        SDL_RenderRect(renderer, &border1);
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 120);
+        drawList.rect(L_LINES, border1, { 0, 0, 0, 200 });
         SDL_FRect border2 = dst; border2.x += 1; border2.y += 1; border2.w -= 2; border2.h -= 2;
-        SDL_RenderRect(renderer, &border2);
+        drawList.rect(L_LINES, border2, { 255, 255, 255, 120 });
     }
 
     // highlight center with a larger border glow
     SDL_FRect centerDst = computeDstForIndex(selected);
-    SDL_SetRenderDrawColor(renderer, 255, 215, 0, 160);
     SDL_FRect glow = centerDst; glow.x -= 4; glow.y -= 4; glow.w += 8; glow.h += 8;
-    SDL_RenderRect(renderer, &glow);
+    drawList.rect(L_LINES, glow, { 255, 215, 0, 160 });
+
+    drawList.flush();
+    drawList.renderStats();
 }
\ No newline at end of file
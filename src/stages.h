@@ -1,21 +1,25 @@
 #pragma once
 #include <SDL3/SDL.h>
 #include <SDL3_image/SDL_image.h>
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include "text.h"
+#include "drawlist.h"
 #include "user.h"
 
 class User; // forward
 
 class Stages {
 public:
-    // onSelect(stageString) called when user clicks centered stage and it's selectable
+    // onSelect(index) called when user clicks centered stage and it's selectable
     Stages(SDL_Renderer* renderer = nullptr);
     ~Stages();
 
-    // callback receives selected stage as a single char, e.g. '1','2','3'
-    bool init(SDL_Renderer* renderer, User* user, int winW, int winH, std::function<void(char)> onSelect);
+    // callback receives the selected StageCatalog index
+    bool init(SDL_Renderer* renderer, User* user, int winW, int winH, std::function<void(int)> onSelect);
     void handleEvent(const SDL_Event& e);
     void update();   // progress animations (called from render loop)
     void render();
@@ -23,10 +27,28 @@ public:
 private:
     SDL_Renderer* renderer = nullptr;
     User* user = nullptr;
-    std::function<void(char)> onSelect;
+    std::function<void(int)> onSelect;
 
-    SDL_Texture* tex[3] = { nullptr, nullptr, nullptr };
+    // carousel previews: decoded + box-filtered to the drawn size on the JobPool,
+    // cached on disk by ImageCache, requested when the carousel gets near them.
+    // Only entries within keepRadius of the selection exist, so memory does not
+    // grow with the catalog size.
+    struct ThumbJob {
+        std::atomic<SDL_Surface*> surface{nullptr};
+        std::atomic<bool> done{false};
+        ~ThumbJob() { if (SDL_Surface* s = surface.load()) SDL_DestroySurface(s); }
+    };
+    struct Thumb {
+        std::string path;
+        SDL_Texture* tex = nullptr;
+        std::shared_ptr<ThumbJob> job; // null until requested; kept alive by the job if we go away first
+    };
+    std::unordered_map<int, Thumb> thumbs; // catalog index -> preview
+    int thumbPxW = 350, thumbPxH = 180; // thumbnail pixel size (center size x output scale)
     int winW = 1920, winH = 991;
+    int count = 0;         // StageCatalog::count()
+    int visibleRadius = 3; // slots that can be on screen either side of the selection
+    int keepRadius = 4;    // thumbnails kept/requested either side of the selection
 
     // sizes
     const int thumbW = 315;
@@ -35,7 +57,7 @@ private:
     const int centerH = 180;
     const int gap = 80; // gap between centers of thumbs
 
-    int selected = 0;      // 0..2
+    int selected = 0;      // 0..count-1
     int prevSelected = 0;
     float slideAnim = 0.0f; // 0..1 when animating between selected states
     bool sliding = false;
@@ -50,8 +72,13 @@ private:
     // question mark text
     Text qmarkText{nullptr};
 
+    DrawList drawList; // whole carousel in a few geometry calls (F3: stats)
+
     // helper
     SDL_FRect computeDstForIndex(int idx, float extraShift = 0.0f) const;
     bool isIndexUnlocked(int idx) const;
     void startSlideTo(int newIndex);
+    void requestThumb(int idx);
+    void pollThumbs(); // upload finished thumbnails, request ones the carousel is near, drop far ones
+    void releaseThumb(Thumb& t);
 };
\ No newline at end of file
@@ -1,22 +1,45 @@
 #include "start.h"
+#include "assets.h"
 #include <iostream>
 #include <fstream>
 #include "ingame/panel.h"
 #include "stages.h"
 #include "game.h"
+#include "audio.h"
+
+extern Audio* g_audioInstance;
 
 Start::Start() {}
 Start::~Start() { cleanup(); }
 
+bool Start::enter(SceneManager* sm)
+{
+    scenes = sm;
+    window = sm->getWindow();
+    renderer = sm->getRenderer();
+    if (g_audioInstance) g_audioInstance->playMusic(Audio::DEFAULT_MUSIC, 1500);
+    init();
+    return true;
+}
+
+void Start::exit() { cleanup(); }
+
+void Start::resume()
+{
+    gameRequested = false;
+    if (g_audioInstance) g_audioInstance->playMusic(Audio::DEFAULT_MUSIC, 1500);
+    // màn chơi vừa đóng có thể đã mở khóa màn mới (cache dùng chung với Game)
+    user.Init();
+}
+
 void Start::init()
 {
-    renderer = SDL_CreateRenderer(window, NULL);
-    bgTexture = IMG_LoadTexture(renderer, "assets/images/background/background.png");
+    bgTexture = Assets::acquireTexture(renderer, "assets/images/background/background.png");
 
     const SDL_Color TextColor = { 0xf9, 0xf2, 0x6a, 0xFF };
 
-    bool hasFile = user.read();
-    user.Init();
+    bool hasFile = user.hasAccounts();
+    user.Init(); // session and logout flag from the store's cache
 
     // Kiểm tra xem user đã đăng nhập hay chưa
     bool isLoggedIn = user.isLoggedIn();
@@ -32,7 +55,6 @@ void Start::init()
         const int panelH = 900;
         if (accountPanel->init(&user, false, panelW, panelH, [this]() {
             pendingShowMainButtons = true;
-            user.read();
             user.Init();
         })) {
             int px = (winW - panelW) / 2;
@@ -49,7 +71,6 @@ void Start::init()
         if (accountPanel->init(&user, true, panelW, panelH, [this]() {
             // Sau khi đăng nhập thành công, hiện main buttons
             pendingShowMainButtons = true;
-            user.read();
             user.Init();
         })) {
             int px = (winW - panelW) / 2;
@@ -62,7 +83,6 @@ void Start::init()
         createMainButtons();
     }
 
-    isRunning = true;
     SDL_MaximizeWindow(window);
 }
 
@@ -122,15 +142,9 @@ void Start::createMainButtons()
     }
 }
 
-void Start::handleEvents()
+void Start::handleEvents(const std::vector<SDL_Event>& events)
 {
-    SDL_Event e;
-    int curW = winW;
-    int curH = winH;
-    while (SDL_PollEvent(&e)) {
-        if (e.type == SDL_EVENT_QUIT) {
-            isRunning = false;
-        }
+    for (const SDL_Event& e : events) {
         // forward to account panel first (if visible, it consumes events inside the panel)
         bool panelActive = false;
         if (!panelActive && accountPanel) {
@@ -152,26 +166,6 @@ void Start::handleEvents()
             if (playBtn) playBtn->handleEvent(e);
             if (settingsBtn) settingsBtn->handleEvent(e);
         }
-
-        // handle window resize by scaling renderer (keep aspect behavior simple)
-        if (e.type == SDL_EVENT_WINDOW_RESIZED)
-        {
-            int w = e.window.data1;
-            int h = e.window.data2;
-            if (w != curW)
-            {
-                h = static_cast<int>(w / windowRatio);
-            }
-            else if (h != curH)
-            {
-                w = static_cast<int>(h * windowRatio);
-            }
-            SDL_SetWindowSize(window, w, h);
-            float scale = static_cast<float>(w) / static_cast<float>(winW);
-            SDL_SetRenderScale(renderer, scale, scale);
-            curW = w;
-            curH = h;
-        }
     }
 
     // If account panel requested to be closed/show main buttons, perform cleanup now
@@ -220,12 +214,11 @@ void Start::render()
 
             std::cerr << "Start::render - slide finished, creating Stages view\n";
             stagesView = std::make_unique<Stages>(renderer);
-            bool ok = stagesView->init(renderer, &user, winW, winH, [this](char stageChar) {
-                // start game with selected stage char: cleanup UI first
-                this->cleanup(); // destroys window/renderer and quits SDL subsystems
-                Game game;
-                game.run(stageChar, window);
-                isRunning = false;
+            bool ok = stagesView->init(renderer, &user, winW, winH, [this](int stageIndex) {
+                // menu stays below the game; the manager pushes it after this frame
+                if (gameRequested) return;
+                gameRequested = true;
+                scenes->push(std::make_unique<Game>(stageIndex));
             });
             std::cerr << "Start::render - Stages::init returned=" << (ok ? "true" : "false") << "\n";
             if (!ok) stagesView.reset();
@@ -242,8 +235,6 @@ void Start::render()
     // render panels over other UI if present
     if (settingsVisible && settingsPanel) settingsPanel->render();
     if (accountPanel) accountPanel->render();
-
-    SDL_RenderPresent(renderer);
 }
 
 void Start::cleanup()
@@ -252,22 +243,7 @@ void Start::cleanup()
     if (settingsBtn) { settingsBtn->cleanup(); settingsBtn.reset(); }
     if (settingsVisible && settingsPanel) { settingsPanel->cleanup(); settingsPanel.reset(); }
     if (accountPanel) { accountPanel->cleanup(); accountPanel.reset(); }
+    stagesView.reset();
 
-    if (bgTexture) { SDL_DestroyTexture(bgTexture); bgTexture = nullptr; }
-    
-    SDL_DestroyRenderer(renderer); renderer = nullptr;
-
-    isRunning = false;
-}
-
-void Start::run(SDL_Window *win)
-{
-    window = win;
-    init();
-    while (isRunning) {
-        handleEvents();
-        render();
-        SDL_Delay(16); // ~60FPS
-    }
-    cleanup();
+    if (bgTexture) { Assets::releaseTexture(bgTexture); bgTexture = nullptr; }
 }
\ No newline at end of file
@@ -9,26 +9,31 @@
 #include "user.h"
 #include "stages.h"
 #include "game.h"
+#include "scene.h"
 
-class Start {
+// Menu scene: account panel, PLAY/SETTINGS, stage carousel.
+// Stays on the stack under the Game scene, so coming back from a level shows the
+// carousel again without rebuilding anything.
+class Start : public Scene {
 public:
     Start();
     ~Start();
 
-    // create window and UI; returns false on failure
-    void init();
-
-    // main loop for the start window (blocking)
-    void run(SDL_Window *window);
+    bool enter(SceneManager* scenes) override;
+    void exit() override;
+    void resume() override;
+    void handleEvents(const std::vector<SDL_Event>& events) override;
+    void render() override;
 
-    // cleanup resources
+    // cleanup resources (the renderer belongs to the SceneManager)
     void cleanup();
 
 private:
-    void handleEvents();
-    void render();
+    void init();
     void createMainButtons();
 
+    SceneManager* scenes = nullptr;
+    bool gameRequested = false; // a Game push is queued / on top; cleared in resume()
     SDL_Window* window = nullptr;
     SDL_Renderer* renderer = nullptr;
     SDL_Texture* bgTexture = nullptr;
@@ -50,8 +55,6 @@ private:
     Uint32 slideDurationMs = 350;
     int playBtnStartX = 0;
     int settingsBtnStartX = 0;
-    bool isRunning = false;
-    int winW = 1920;
-    int winH = 991;
-    float windowRatio = 1920.0/991.0;
+    int winW = SceneManager::LOGICAL_W;
+    int winH = SceneManager::LOGICAL_H;
 };
\ No newline at end of file
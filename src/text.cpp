@@ -1,4 +1,5 @@
 #include "text.h"
+#include "assets.h"
 #include <iostream>
 #include <algorithm>
 #include <cstring>
@@ -19,7 +20,7 @@ bool Text::create(SDL_Renderer* rend, const std::string& fPath, int fSize, const
 
     if (!renderer) { std::cerr << "Text::create - no renderer\n"; return false; }
 
-    font = TTF_OpenFont(fontPath.c_str(), fontSize);
+    font = Assets::openFont(fontPath, fontSize);
     if (!font) {
         std::cerr << "Text::create - TTF_OpenFont failed for " << fontPath << " | " << SDL_GetError() << "\n";
          return false;
@@ -36,6 +37,8 @@ bool Text::create(SDL_Renderer* rend, const std::string& fPath, int fSize, const
 
 bool Text::updateTexture()
 {
+    ++version;
+
     // free old texture
     if (texture) {
         SDL_DestroyTexture(texture);
@@ -192,7 +195,7 @@ bool Text::setFontSize(int size)
         TTF_CloseFont(font);
         font = nullptr;
     }
-    font = TTF_OpenFont(fontPath.c_str(), fontSize);
+    font = Assets::openFont(fontPath, fontSize);
     if (!font) {
         std::cerr << "Text::setFontSize - TTF_OpenFont failed for " << fontPath << " | " << SDL_GetError() << "\n";
          return false;
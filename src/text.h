@@ -18,6 +18,8 @@ private:
     // wrap width in pixels, 0 = no wrap
     int wrapWidth = 0;
 
+    uint32_t version = 0; // bumped whenever the texture is rebuilt
+
     bool updateTexture();
 
 public:
@@ -47,6 +49,10 @@ public:
     int getY() const;
     int getWidth() const;
     int getHeight() const;
+    // changes whenever the rendered image changes (text, font, color, wrap)
+    uint32_t getVersion() const { return version; }
+    // current texture (nullptr for empty text), for batching through DrawList
+    SDL_Texture* getTexture() const { return texture; }
 
     // free resources
     void cleanup();
@@ -2,60 +2,65 @@
 #include <cstdint>
 #include <string>
 #include <vector>
+#include "userstore.h"
 
 class Start;
 class Game;
 
 class User {
 public:
-    struct Record {
-        std::string username;
-        std::string password;
-        char stage = '0';
-    };
+    using Record = UserStore::Record;
 
+    // accounts live in UserStore (journal users.bin + hash index users.idx); a User is the
+    // current session on top of it, and every User on the same file shares one store.
+    // Reads come from the store's cache and saves are written behind, so no call except
+    // login/signin waits for the disk.
     User(const std::string& filepath = "users.bin");
     ~User();
 
     // file IO
-    bool write();                 // write current records -> file
-    bool read();                  // read records <- file
+    bool write();                 // compact the journal (on the store's writer thread)
+    // users.bin holds accounts; answered from the store's cache, never by reading the journal
+    bool hasAccounts() const;
 
-    // initialize the in-memory current user from file (first record)
+    // initialize the in-memory current user from file (the active account)
     void Init();
 
     // authentication / session management
     bool login(const std::string& user, const std::string& pass);
-    void logout();                // save current user into first record (persist)
-    bool signin(const std::string& user, const std::string& pass);
+    void logout();                // mark explicit logout (persist)
+    bool signin(const std::string& user, const std::string& pass); // false if the name is taken
 
     // accessors
     std::string getUsername() const;
     std::string getPassword() const;
-    char getStage() const;
-    void setStage(char s);
-    bool updateStage(char newStage);
+    int getProgress() const;
+    void setProgress(int p);
+    // raise progress (never lowers it) and persist (one Progress entry)
+    bool updateProgress(int cleared);
+
+    // per-level results of the current user, by StageInfo::id; recording never waits for the
+    // disk, the leaderboard fills in once the store has merged the run (watch boardVersion())
+    bool recordResult(int stageId, bool won, int moves, int timeMs);
+    bool levelBoard(int stageId, size_t k, LevelStats& mine, size_t& rank, size_t& ranked,
+                    std::vector<Leaderboards::Standing>& top) const;
+    uint64_t boardVersion() const { return store->boardVersion(); }
 
     // persisted sign flag: 0 = last session not explicitly logged out, 1 = explicitly logged out
     void setSign(bool s);
     bool getSign() const;
     bool isLoggedIn() const;
 
-    // all records (useful for external tools)
-    const std::vector<Record>& all() const { return records; }
+    // all records, by a full replay of the journal (useful for external tools)
+    std::vector<Record> all() const { return store->loadAll(); }
 
 private:
-    std::string path;
-    std::vector<Record> records;
+    UserStore* store = nullptr; // shared, owned by UserStore::get
 
-    // currently active user info (copied from records.front() when logged in)
+    // currently active user info
     std::string username;
     std::string password;
-    char stage = '0';
-
-    uint8_t sign = 0; // persisted flag stored in the binary file
+    int progress = 0;
 
-    // helpers
-    bool writeString(std::ofstream& ofs, const std::string& s);
-    bool readString(std::ifstream& ifs, std::string& s);
-};
\ No newline at end of file
+    uint8_t sign = 0; // persisted flag stored in the journal
+};
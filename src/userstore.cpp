@@ -0,0 +1,1103 @@
+#include "userstore.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 4 was Stats keyed by catalog index (pre-release), now skipped like an unknown kind
+enum EntryKind : uint8_t {
+    ENTRY_ACCOUNT = 1, ENTRY_PROGRESS = 2, ENTRY_SESSION = 3, ENTRY_STATS = 5, ENTRY_BOARDS = 6
+};
+
+const size_t HEADER_BYTES = 8;           // magic + version
+const size_t ENTRY_OVERHEAD = 1 + 4 + 4; // kind + size + crc
+const uint64_t MAX_STRING_LEN = 1 << 20; // 1 MiB max per string
+
+uint32_t crc32(const char* p, size_t n)
+{
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; ++i) c = table[(c ^ static_cast<uint8_t>(p[i])) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+// FNV-1a; 0 marks an empty slot
+uint32_t hashName(const std::string& name)
+{
+    uint32_t h = 2166136261u;
+    for (char c : name) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 16777619u;
+    }
+    return h ? h : 1;
+}
+
+void putU32(std::string& o, uint32_t v) { o.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+void putI32(std::string& o, int32_t v) { o.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+void putStr(std::string& o, const std::string& s)
+{
+    putU32(o, static_cast<uint32_t>(s.size()));
+    o += s;
+}
+
+// write `data` at the end of `file` (created if needed) or as its whole content, and with
+// `sync` wait until it is on the disk: a flushed ofstream only reaches the OS cache, which
+// a power cut loses
+bool writeFile(const std::string& file, const std::string& data, bool append, bool sync)
+{
+#ifdef _WIN32
+    HANDLE h = CreateFileA(file.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                           append ? OPEN_ALWAYS : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER zero{};
+    bool ok = !append || SetFilePointerEx(h, zero, nullptr, FILE_END);
+    for (size_t done = 0; ok && done < data.size();) {
+        DWORD n = 0;
+        const DWORD chunk = static_cast<DWORD>(std::min<size_t>(data.size() - done, 1u << 30));
+        ok = WriteFile(h, data.data() + done, chunk, &n, nullptr) && n > 0;
+        done += n;
+    }
+    if (ok && sync) ok = FlushFileBuffers(h) != 0;
+    CloseHandle(h);
+    return ok;
+#else
+    const int fd = ::open(file.c_str(), O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), 0644);
+    if (fd < 0) return false;
+    bool ok = true;
+    for (size_t done = 0; ok && done < data.size();) {
+        const ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        ok = n > 0;
+        if (ok) done += static_cast<size_t>(n);
+    }
+    if (ok && sync) ok = ::fsync(fd) == 0;
+    return ::close(fd) == 0 && ok;
+#endif
+}
+
+bool syncFile(const std::string& file)
+{
+#ifdef _WIN32
+    HANDLE h = CreateFileA(file.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    const bool ok = FlushFileBuffers(h) != 0;
+    CloseHandle(h);
+    return ok;
+#else
+    const int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+
+// replace `to` with `from` in one step and make the new name durable
+bool replaceFile(const std::string& from, const std::string& to, std::string& error)
+{
+#ifdef _WIN32
+    if (!MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        error = "error " + std::to_string(GetLastError());
+        return false;
+    }
+    return true;
+#else
+    std::error_code ec;
+    std::filesystem::rename(from, to, ec);
+    if (ec) {
+        error = ec.message();
+        return false;
+    }
+    // the rename is an entry in the directory: sync it too, or a power cut can undo it
+    const std::filesystem::path parent = std::filesystem::path(to).parent_path();
+    syncFile(parent.empty() ? "." : parent.string());
+    return true;
+#endif
+}
+
+// kind, size, payload, crc
+void encodeEntry(std::string& out, uint8_t kind, const std::string& payload)
+{
+    const size_t start = out.size();
+    out.push_back(static_cast<char>(kind));
+    putU32(out, static_cast<uint32_t>(payload.size()));
+    out += payload;
+    putU32(out, crc32(out.data() + start, out.size() - start));
+}
+
+std::string accountPayload(const UserStore::Record& r)
+{
+    std::string p;
+    putStr(p, r.username);
+    putStr(p, r.password);
+    putI32(p, r.progress);
+    return p;
+}
+
+std::string sessionPayload(uint8_t sign, int32_t active)
+{
+    std::string p(1, static_cast<char>(sign));
+    putI32(p, active);
+    return p;
+}
+
+std::string statsPayload(uint32_t id, uint32_t stageId, const LevelStats& s)
+{
+    std::string p;
+    putU32(p, id);
+    putU32(p, stageId);
+    putU32(p, s.bestMoves);
+    putU32(p, s.bestTimeMs);
+    putU32(p, s.attempts);
+    return p;
+}
+
+// Boards: every stats row plus the names of the accounts that have one, so the leaderboards
+// load from this entry and the few entries after it instead of a replay
+std::string boardsPayload(uint32_t accounts, const std::unordered_map<uint64_t, LevelStats>& stats,
+                          const std::vector<UserStore::Record>& records)
+{
+    std::string p;
+    putU32(p, accounts);
+    putU32(p, static_cast<uint32_t>(stats.size()));
+    std::vector<uint32_t> ids;
+    for (const auto& it : stats) {
+        const uint32_t id = static_cast<uint32_t>(it.first >> 32);
+        putU32(p, id);
+        putU32(p, static_cast<uint32_t>(it.first));
+        putU32(p, it.second.bestMoves);
+        putU32(p, it.second.bestTimeMs);
+        putU32(p, it.second.attempts);
+        ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    putU32(p, static_cast<uint32_t>(ids.size()));
+    for (uint32_t id : ids) {
+        putU32(p, id);
+        putStr(p, records[id].username);
+    }
+    return p;
+}
+
+// bounds-checked cursor over a loaded file / entry payload
+struct Reader {
+    const char* p;
+    const char* end;
+
+    bool raw(void* dst, size_t n)
+    {
+        if (static_cast<size_t>(end - p) < n) return false;
+        std::memcpy(dst, p, n);
+        p += n;
+        return true;
+    }
+    template <typename T> bool get(T& v) { return raw(&v, sizeof(v)); }
+    template <typename Len> bool str(std::string& s)
+    {
+        Len n = 0;
+        if (!get(n)) return false;
+        if (n > MAX_STRING_LEN) {
+            std::cerr << "UserStore - string length too large: " << n << "\n";
+            return false;
+        }
+        if (static_cast<uint64_t>(end - p) < n) return false;
+        s.assign(p, static_cast<size_t>(n));
+        p += n;
+        return true;
+    }
+};
+
+bool readStats(Reader& in, uint32_t& id, uint32_t& stageId, LevelStats& s)
+{
+    return in.get(id) && in.get(stageId) && in.get(s.bestMoves) && in.get(s.bestTimeMs) && in.get(s.attempts);
+}
+
+// calls f(kind, offset, payload) for each intact entry of data[pos, size) until it returns false;
+// returns the end of the last entry taken (a cut off or corrupt entry stops the scan)
+template <typename F> size_t scanEntries(const char* data, size_t size, size_t pos, F f)
+{
+    while (size - pos >= ENTRY_OVERHEAD) {
+        const uint8_t kind = static_cast<uint8_t>(data[pos]);
+        uint32_t len = 0;
+        std::memcpy(&len, data + pos + 1, sizeof(len));
+        if (len > size - pos - ENTRY_OVERHEAD) break; // cut off
+        uint32_t stored = 0;
+        std::memcpy(&stored, data + pos + 5 + len, sizeof(stored));
+        if (crc32(data + pos, 5 + len) != stored) break;
+        Reader in{ data + pos + 5, data + pos + 5 + len };
+        if (!f(kind, pos, in)) break;
+        pos += ENTRY_OVERHEAD + len;
+    }
+    return pos;
+}
+
+std::string readWhole(const std::string& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+}
+
+std::map<std::string, std::unique_ptr<UserStore>>& registry()
+{
+    static std::map<std::string, std::unique_ptr<UserStore>> stores;
+    return stores;
+}
+
+} // namespace
+
+UserStore& UserStore::get(const std::string& path)
+{
+    std::unique_ptr<UserStore>& s = registry()[path];
+    if (!s) s.reset(new UserStore(path));
+    return *s;
+}
+
+void UserStore::shutdownAll()
+{
+    for (auto& it : registry()) it.second->shutdown();
+}
+
+UserStore::UserStore(const std::string& p)
+    : path(p), indexPath(std::filesystem::path(p).replace_extension(".idx").string()) {}
+
+UserStore::~UserStore() { shutdown(); }
+
+void UserStore::close()
+{
+    flush();
+    std::lock_guard<std::mutex> io(ioMutex);
+    index.close();
+    journalView.close();
+    cache = Cache();
+}
+
+// ---------- opening ----------
+
+bool UserStore::open()
+{
+    if (index.isOpen()) return true;
+
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) return false; // no file -> no accounts yet
+    char head[HEADER_BYTES] = {};
+    ifs.read(head, HEADER_BYTES);
+    const bool magic = ifs.gcount() == static_cast<std::streamsize>(HEADER_BYTES) && std::memcmp(head, "MMUS", 4) == 0;
+    uint32_t version = 0;
+    if (magic) std::memcpy(&version, head + 4, sizeof(version));
+    ifs.close();
+
+    if (!magic || version == 2) return convert(readWhole(path));
+    if (version < 3 || version > FILE_VERSION) {
+        std::cerr << "UserStore - unsupported " << path << " version " << version << "\n";
+        return false;
+    }
+
+    // the index is trusted only if it describes exactly this journal
+    std::error_code ec;
+    const uint64_t bytes = std::filesystem::file_size(path, ec);
+    if (!ec && std::filesystem::exists(indexPath, ec) && index.openWritable(indexPath)) {
+        const IndexHeader* h = header();
+        if (index.size() >= sizeof(IndexHeader) && std::memcmp(h->magic, "MMIX", 4) == 0
+            && h->version == INDEX_VERSION && h->capacity >= MIN_CAPACITY
+            && (h->capacity & (h->capacity - 1)) == 0
+            && index.size() == sizeof(IndexHeader) + static_cast<size_t>(h->capacity) * sizeof(Slot)
+            && h->count <= h->capacity / 2 && h->journalBytes == bytes)
+            return true;
+        index.close();
+    }
+    return rebuild();
+}
+
+bool UserStore::createEmpty()
+{
+    std::error_code ec;
+    if (std::filesystem::exists(path, ec)) return false; // there but unreadable: never overwrite it
+    Replay state;
+    return writeJournal(state) && writeIndex(state);
+}
+
+bool UserStore::rebuild()
+{
+    Replay state;
+    if (!readJournal(state)) return false;
+    if (state.goodBytes < state.fileBytes) {
+        // thường là lần ghi cuối bị ngắt giữa chừng; viết lại phần còn tốt để lần append sau không nối vào rác
+        std::cerr << "UserStore - " << path << ": dropped " << (state.fileBytes - state.goodBytes)
+                  << " damaged bytes at offset " << state.goodBytes << "\n";
+        return writeJournal(state) && writeIndex(state);
+    }
+    std::cerr << "UserStore - rebuilding " << indexPath << " (" << state.records.size() << " accounts)\n";
+    return writeIndex(state);
+}
+
+// v2 / old layout -> journal + index
+bool UserStore::convert(const std::string& data)
+{
+    Replay state;
+    Reader in{ data.data(), data.data() + data.size() };
+    // v2 starts with the magic; the old one starts straight with the sign byte
+    const bool legacy = data.size() < HEADER_BYTES || data.compare(0, 4, "MMUS") != 0;
+    if (!legacy) in.p += HEADER_BYTES;
+
+    bool ok = in.get(state.sign);
+    uint64_t count = 0;
+    ok = ok && in.get(count);
+    for (uint64_t i = 0; ok && i < count; ++i) {
+        Record r;
+        ok = in.str<uint64_t>(r.username) && in.str<uint64_t>(r.password);
+        if (ok && legacy) {
+            // old records kept the highest unlocked stage as '0'..'3'; '2' meant stage 1 was cleared
+            char stage = '0';
+            ok = in.get(stage);
+            r.progress = stage > '1' ? stage - '1' : 0;
+        } else if (ok) {
+            ok = in.get(r.progress);
+        }
+        if (ok) state.records.push_back(std::move(r));
+    }
+    if (state.records.empty() && !ok) {
+        std::cerr << "UserStore - " << path << " is not an account file\n";
+        return false;
+    }
+    // snapshots kept the current user in front
+    state.active = state.records.empty() ? -1 : 0;
+    std::cerr << "UserStore - converting " << path << " (" << state.records.size() << " accounts) to the journal format\n";
+    return writeJournal(state) && writeIndex(state);
+}
+
+// ---------- journal ----------
+
+bool UserStore::readJournal(Replay& out)
+{
+    const std::string data = readWhole(path);
+    uint32_t version = 0;
+    if (data.size() < HEADER_BYTES || data.compare(0, 4, "MMUS") != 0) return false;
+    std::memcpy(&version, data.data() + 4, sizeof(version));
+    if (version < 3 || version > FILE_VERSION) return false; // 3 is 4 without Boards entries
+
+    out = Replay();
+    out.fileBytes = data.size();
+    out.goodBytes = scanEntries(data.data(), data.size(), HEADER_BYTES, [&](uint8_t kind, size_t pos, Reader& in) {
+        bool ok = true;
+        if (kind == ENTRY_ACCOUNT) {
+            Record r;
+            ok = in.str<uint32_t>(r.username) && in.str<uint32_t>(r.password) && in.get(r.progress);
+            if (ok) {
+                out.records.push_back(std::move(r));
+                out.offsets.push_back(static_cast<uint32_t>(pos));
+            }
+        } else if (kind == ENTRY_PROGRESS) {
+            uint32_t id = 0;
+            int32_t p = 0;
+            ok = in.get(id) && in.get(p);
+            if (ok && id < out.records.size()) out.records[id].progress = p;
+        } else if (kind == ENTRY_SESSION) {
+            int32_t id = -1;
+            ok = in.get(out.sign) && in.get(id);
+            out.active = (id >= 0 && static_cast<size_t>(id) < out.records.size()) ? id : -1;
+        } else if (kind == ENTRY_STATS) {
+            uint32_t id = 0, stageId = 0;
+            LevelStats s;
+            ok = readStats(in, id, stageId, s);
+            if (ok && id < out.records.size()) out.stats[(static_cast<uint64_t>(id) << 32) | stageId] = s;
+        } else if (kind == ENTRY_BOARDS) {
+            // the rows only; the names are in the Account entries already read
+            uint32_t accounts = 0, rows = 0;
+            ok = in.get(accounts) && in.get(rows);
+            for (uint32_t i = 0; ok && i < rows; ++i) {
+                uint32_t id = 0, stageId = 0;
+                LevelStats s;
+                ok = readStats(in, id, stageId, s);
+                if (ok && id < out.records.size()) out.stats[(static_cast<uint64_t>(id) << 32) | stageId] = s;
+            }
+            if (ok) out.boardsOffset = static_cast<uint32_t>(pos);
+        } // other kinds: written by a newer build, skipped
+        if (ok) ++out.entries;
+        return ok;
+    });
+    return true;
+}
+
+// the whole state as a fresh journal, committed by renaming a temp file over the old one
+bool UserStore::writeJournal(Replay& state)
+{
+    std::string out("MMUS", 4);
+    putU32(out, FILE_VERSION);
+    state.offsets.clear();
+    for (const auto& r : state.records) {
+        state.offsets.push_back(static_cast<uint32_t>(out.size()));
+        encodeEntry(out, ENTRY_ACCOUNT, accountPayload(r));
+    }
+    state.boardsOffset = static_cast<uint32_t>(out.size());
+    encodeEntry(out, ENTRY_BOARDS, boardsPayload(static_cast<uint32_t>(state.records.size()), state.stats, state.records));
+    encodeEntry(out, ENTRY_SESSION, sessionPayload(state.sign, state.active));
+    state.entries = static_cast<uint32_t>(state.records.size() + 2);
+    state.goodBytes = state.fileBytes = out.size();
+
+    const std::string tmp = path + ".tmp";
+    std::error_code ec;
+    // on the disk before the rename, otherwise a power cut can leave the new name on an empty file
+    if (!writeFile(tmp, out, false, true)) {
+        std::cerr << "UserStore - failed to write " << tmp << "\n";
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+
+    // the old index describes the old file; without one a crash here means a rebuild, not a wrong offset
+    index.close();
+    journalView.close();
+    std::filesystem::remove(indexPath, ec);
+    // rename thay thế file cũ trong một bước: crash hay mất điện lúc nào cũng còn nguyên một bản
+    std::string error;
+    if (!replaceFile(tmp, path, error)) {
+        std::cerr << "UserStore - failed to replace " << path << " | " << error << "\n";
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    unsyncedAppends = false;
+    return true;
+}
+
+bool UserStore::append(const std::string& entries, uint64_t& endBytes)
+{
+    IndexHeader* h = header();
+    const uint64_t start = h->journalBytes;
+    h->journalBytes = STALE;
+
+    // a writer batch syncs once at its end (syncJournal), everything else right away
+    if (!writeFile(path, entries, true, !batching)) {
+        std::cerr << "UserStore - failed to append to " << path << "\n";
+        index.close(); // stale: the next call replays whatever made it to the file
+        return false;
+    }
+    endBytes = start + entries.size();
+    unsyncedAppends = batching;
+    return true;
+}
+
+bool UserStore::syncJournal()
+{
+    if (!unsyncedAppends) return true;
+    unsyncedAppends = false;
+    if (syncFile(path)) return true;
+    std::cerr << "UserStore - failed to sync " << path << "\n";
+    return false;
+}
+
+bool UserStore::commit(uint64_t journalBytes, uint32_t count)
+{
+    IndexHeader* h = header();
+    h->entries += count;
+    h->journalBytes = journalBytes; // last: the index is valid again
+    // a compaction replays the whole journal: never inline here, the writer does it at the end
+    // of its batch (apply() checks compactDue() itself)
+    if (!batching && compactDue()) {
+        // ioMutex -> writerMutex; the writer never takes them the other way round
+        std::lock_guard<std::mutex> lock(writerMutex);
+        if (!stopped) {
+            pending.compact = true;
+            startWriter();
+        }
+    }
+    return true;
+}
+
+bool UserStore::compactDue() const
+{
+    const IndexHeader* h = header();
+    // boardsOffset 0: journal of an older build, the leaderboards can only come from a replay
+    return h->entries > h->baseEntries + COMPACT_SLACK || h->boardsOffset == 0;
+}
+
+bool UserStore::appendSession(uint8_t sign, uint32_t slot)
+{
+    const int32_t id = slot != NO_SLOT ? static_cast<int32_t>(slots()[slot].id) : -1;
+    std::string e;
+    encodeEntry(e, ENTRY_SESSION, sessionPayload(sign, id));
+    uint64_t end = 0;
+    if (!append(e, end)) return false;
+    IndexHeader* h = header();
+    h->sign = sign;
+    h->activeSlot = slot;
+    return commit(end, 1);
+}
+
+// ---------- index ----------
+
+bool UserStore::createIndex(uint32_t capacity)
+{
+    static_assert(sizeof(IndexHeader) == 64, "users.idx header must be 64 bytes");
+    static_assert(sizeof(Slot) == 16, "users.idx slot must be 16 bytes");
+
+    index.close();
+    std::error_code ec;
+    std::filesystem::remove(indexPath, ec);
+    const size_t bytes = sizeof(IndexHeader) + static_cast<size_t>(capacity) * sizeof(Slot);
+    if (!index.openWritable(indexPath, bytes) || index.size() != bytes) {
+        std::cerr << "UserStore - failed to map " << indexPath << "\n";
+        index.close();
+        return false;
+    }
+    std::memset(index.writableData(), 0, bytes);
+    IndexHeader* h = header();
+    std::memcpy(h->magic, "MMIX", 4);
+    h->version = INDEX_VERSION;
+    h->capacity = capacity;
+    h->activeSlot = NO_SLOT;
+    h->journalBytes = STALE;
+    return true;
+}
+
+bool UserStore::writeIndex(const Replay& state)
+{
+    uint32_t capacity = MIN_CAPACITY;
+    while (capacity < state.records.size() * 2 + 2) capacity *= 2;
+    if (!createIndex(capacity)) return false;
+
+    IndexHeader* h = header();
+    for (size_t i = 0; i < state.records.size(); ++i) {
+        uint32_t at = NO_SLOT;
+        insertSlot(hashName(state.records[i].username), state.offsets[i], static_cast<uint32_t>(i),
+                   state.records[i].progress, &at);
+        if (static_cast<int32_t>(i) == state.active) h->activeSlot = at;
+    }
+    h->nextId = static_cast<uint32_t>(state.records.size());
+    h->entries = state.entries;
+    h->baseEntries = static_cast<uint32_t>(state.records.size() + 2);
+    h->boardsOffset = state.boardsOffset;
+    h->sign = state.sign;
+    h->journalBytes = state.fileBytes; // last: the index is valid from here on
+    return true;
+}
+
+// twice the capacity, same slots; the active account is followed by id since slots move
+bool UserStore::grow()
+{
+    const IndexHeader old = *header();
+    const Slot* s = slots();
+    std::vector<Slot> live;
+    live.reserve(old.count);
+    for (uint32_t i = 0; i < old.capacity; ++i)
+        if (s[i].hash) live.push_back(s[i]);
+    const uint32_t activeId = old.activeSlot != NO_SLOT ? s[old.activeSlot].id : NO_SLOT;
+
+    if (!createIndex(old.capacity * 2)) return false;
+    IndexHeader* h = header();
+    for (const Slot& e : live) {
+        uint32_t at = NO_SLOT;
+        insertSlot(e.hash, e.offset, e.id, e.progress, &at);
+        if (e.id == activeId) h->activeSlot = at;
+    }
+    h->nextId = old.nextId;
+    h->entries = old.entries;
+    h->baseEntries = old.baseEntries;
+    h->boardsOffset = old.boardsOffset;
+    h->sign = old.sign;
+    h->journalBytes = old.journalBytes;
+    return true;
+}
+
+void UserStore::insertSlot(uint32_t hash, uint32_t offset, uint32_t id, int32_t progress, uint32_t* at)
+{
+    IndexHeader* h = header();
+    Slot* s = slots();
+    const uint32_t mask = h->capacity - 1;
+    uint32_t i = hash & mask;
+    while (s[i].hash) i = (i + 1) & mask; // linear probing, load factor <= 1/2
+    s[i] = { hash, offset, id, progress };
+    ++h->count;
+    if (at) *at = i;
+}
+
+uint32_t UserStore::findSlot(const std::string& user, const std::string* pass, Record* out)
+{
+    const IndexHeader* h = header();
+    const Slot* s = slots();
+    const uint32_t hash = hashName(user);
+    const uint32_t mask = h->capacity - 1;
+    for (uint32_t i = hash & mask; s[i].hash; i = (i + 1) & mask) {
+        if (s[i].hash != hash) continue;
+        Record r;
+        if (!readAccount(s[i].offset, r) || r.username != user) continue;
+        if (pass && r.password != *pass) continue;
+        r.progress = s[i].progress;
+        if (out) *out = std::move(r);
+        return i;
+    }
+    return NO_SLOT;
+}
+
+// one Account entry, read at its offset and checked
+bool UserStore::mapJournal(uint64_t end)
+{
+    if (journalView.isOpen() && journalView.size() >= end) return true;
+    // entry appended after the view was made (or no view yet)
+    return journalView.open(path, true) && journalView.size() >= end;
+}
+
+bool UserStore::readAccount(uint32_t offset, Record& out)
+{
+    if (!mapJournal(static_cast<uint64_t>(offset) + 5)) return false;
+    const char* entry = reinterpret_cast<const char*>(journalView.data()) + offset;
+    if (static_cast<uint8_t>(entry[0]) != ENTRY_ACCOUNT) return false;
+    uint32_t size = 0;
+    std::memcpy(&size, entry + 1, sizeof(size));
+    if (size > 2 * MAX_STRING_LEN + 12) return false;
+    if (!mapJournal(static_cast<uint64_t>(offset) + 5 + size + 4)) return false;
+    entry = reinterpret_cast<const char*>(journalView.data()) + offset; // the view may have moved
+    uint32_t stored = 0;
+    std::memcpy(&stored, entry + 5 + size, sizeof(stored));
+    if (crc32(entry, 5 + size) != stored) return false;
+
+    Reader in{ entry + 5, entry + 5 + size };
+    return in.str<uint32_t>(out.username) && in.str<uint32_t>(out.password) && in.get(out.progress);
+}
+
+// ---------- journal writes (ioMutex held) ----------
+
+bool UserStore::writeSignedOut(bool signedOut)
+{
+    if (!open()) return false;
+    const IndexHeader* h = header();
+    const uint8_t sign = signedOut ? 1 : 0;
+    if (h->sign == sign) return true;
+    return appendSession(sign, h->activeSlot);
+}
+
+bool UserStore::writeProgress(int32_t progress)
+{
+    if (!open()) return false;
+    const IndexHeader* h = header();
+    if (h->activeSlot == NO_SLOT) return false;
+    Slot& s = slots()[h->activeSlot];
+    if (s.progress == progress) return true;
+
+    std::string p;
+    putU32(p, s.id);
+    putI32(p, progress);
+    std::string e;
+    encodeEntry(e, ENTRY_PROGRESS, p);
+    uint64_t end = 0;
+    if (!append(e, end)) return false;
+    s.progress = progress;
+    return commit(end, 1);
+}
+
+bool UserStore::rewrite()
+{
+    Replay state;
+    if (!readJournal(state)) return false;
+    return writeJournal(state) && writeIndex(state);
+}
+
+// ---------- writer thread ----------
+
+void UserStore::markDirty(const Pending& change)
+{
+    std::unique_lock<std::mutex> lock(writerMutex);
+    if (change.progress) {
+        pending.progress = true;
+        pending.progressValue = change.progressValue;
+    }
+    if (change.sign) {
+        pending.sign = true;
+        pending.signedOut = change.signedOut;
+    }
+    pending.compact = pending.compact || change.compact;
+    pending.loadBoards = pending.loadBoards || change.loadBoards;
+    pending.results.insert(pending.results.end(), change.results.begin(), change.results.end());
+
+    if (stopped) {
+        // sau shutdown() không còn writer: ghi luôn
+        Pending work = pending;
+        pending = Pending();
+        lock.unlock();
+        std::lock_guard<std::mutex> io(ioMutex);
+        apply(work);
+        return;
+    }
+    startWriter();
+}
+
+void UserStore::startWriter()
+{
+    if (!writer.joinable()) {
+        writerRunning = true;
+        writer = std::thread(&UserStore::writerMain, this);
+    }
+    writerWake.notify_one();
+}
+
+void UserStore::writerMain()
+{
+    std::unique_lock<std::mutex> lock(writerMutex);
+    for (;;) {
+        writerWake.wait(lock, [this] { return pending.any() || !writerRunning; });
+        if (!pending.any()) break; // stopping with nothing left to write
+        // chờ thêm một chút để một loạt thay đổi liên tiếp chỉ thành một lần ghi
+        // (kết quả màn chơi thì không chờ: victory panel đang đợi thứ hạng)
+        writerWake.wait_for(lock, std::chrono::milliseconds(COALESCE_MS), [this] {
+            return flushRequested || !writerRunning || !pending.results.empty();
+        });
+        Pending work = pending;
+        pending = Pending();
+        writing = true;
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> io(ioMutex);
+            apply(work);
+        }
+        lock.lock();
+        writing = false;
+        writerIdle.notify_all();
+    }
+}
+
+void UserStore::apply(const Pending& work)
+{
+    batching = true;
+    if (work.loadBoards || !work.results.empty()) loadBoards();
+    if (work.progress && !writeProgress(work.progressValue))
+        std::cerr << "UserStore - failed to save progress " << work.progressValue << " to " << path << "\n";
+    if (work.sign && !writeSignedOut(work.signedOut))
+        std::cerr << "UserStore - failed to save the session to " << path << "\n";
+    for (const Result& r : work.results)
+        if (!writeResult(r)) std::cerr << "UserStore - failed to save the result of stage " << r.stageId << "\n";
+    if (open() && (work.compact || compactDue()) && !rewrite())
+        std::cerr << "UserStore - failed to compact " << path << "\n";
+    batching = false;
+    syncJournal(); // one sync for the whole batch
+}
+
+// ---------- leaderboards ----------
+
+void UserStore::loadBoards()
+{
+    {
+        std::lock_guard<std::mutex> lock(boardsMutex);
+        if (boardsLoaded) return;
+    }
+    if (!open()) return;
+    Leaderboards loaded;
+    if (!readBoards(loaded)) {
+        // no Boards entry (journal of an older build, compacted at the end of this batch): replay
+        Replay state;
+        if (!readJournal(state)) return;
+        loaded.clear();
+        for (size_t i = 0; i < state.records.size(); ++i)
+            loaded.setName(static_cast<uint32_t>(i), state.records[i].username);
+        for (const auto& it : state.stats)
+            loaded.set(static_cast<uint32_t>(it.first >> 32), static_cast<uint32_t>(it.first), it.second);
+    }
+    {
+        std::lock_guard<std::mutex> lock(boardsMutex);
+        boards = std::move(loaded);
+        boardsLoaded = true;
+    }
+    boardsVersion.fetch_add(1, std::memory_order_release);
+}
+
+// the Boards entry the index points at, then the entries appended after it (fewer than
+// COMPACT_SLACK); false when there is none or the tail does not read back to journalBytes
+bool UserStore::readBoards(Leaderboards& out)
+{
+    const IndexHeader* h = header();
+    const uint32_t start = h->boardsOffset;
+    const uint64_t end = h->journalBytes;
+    if (start == 0 || end == STALE || start >= end || !mapJournal(end)) return false;
+
+    const char* data = reinterpret_cast<const char*>(journalView.data());
+    uint32_t nextId = 0; // Account entries after the snapshot get the ids that follow
+    bool found = false;
+    const size_t stop = scanEntries(data, static_cast<size_t>(end), start, [&](uint8_t kind, size_t pos, Reader& in) {
+        uint32_t id = 0, stageId = 0;
+        LevelStats s;
+        if (pos == start) {
+            uint32_t rows = 0, names = 0;
+            if (kind != ENTRY_BOARDS || !in.get(nextId) || !in.get(rows)) return false;
+            for (uint32_t i = 0; i < rows; ++i) {
+                if (!readStats(in, id, stageId, s)) return false;
+                out.set(id, stageId, s);
+            }
+            if (!in.get(names)) return false;
+            for (uint32_t i = 0; i < names; ++i) {
+                std::string name;
+                if (!in.get(id) || !in.str<uint32_t>(name)) return false;
+                out.setName(id, name);
+            }
+            found = true;
+        } else if (kind == ENTRY_ACCOUNT) {
+            std::string name;
+            if (!in.str<uint32_t>(name)) return false;
+            out.setName(nextId++, name);
+        } else if (kind == ENTRY_STATS) {
+            if (!readStats(in, id, stageId, s)) return false;
+            if (id < nextId) out.set(id, stageId, s);
+        }
+        return true;
+    });
+    return found && stop == end;
+}
+
+bool UserStore::writeResult(const Result& r)
+{
+    // the entry holds the merged totals: merging into empty boards (journal unreadable when
+    // they were loaded) would append a row that replaces the saved stats with this run alone
+    loadBoards(); // no-op once loaded; otherwise one more try
+    {
+        std::lock_guard<std::mutex> lock(boardsMutex);
+        if (!boardsLoaded) {
+            std::cerr << "UserStore - leaderboards not loaded, result of stage " << r.stageId << " not saved\n";
+            return false;
+        }
+    }
+    if (!open()) return false;
+    const IndexHeader* h = header();
+    if (h->activeSlot == NO_SLOT) return false;
+    const uint32_t id = slots()[h->activeSlot].id;
+
+    LevelStats s;
+    {
+        std::lock_guard<std::mutex> lock(boardsMutex);
+        s = boards.get(id, r.stageId);
+        ++s.attempts;
+        if (r.won) {
+            if (!s.cleared() || r.moves < s.bestMoves) s.bestMoves = std::max<uint32_t>(r.moves, 1);
+            if (!s.cleared() || s.bestTimeMs == 0 || r.timeMs < s.bestTimeMs) s.bestTimeMs = r.timeMs;
+        }
+        boards.set(id, r.stageId, s);
+    }
+    boardsVersion.fetch_add(1, std::memory_order_release);
+
+    std::string e;
+    encodeEntry(e, ENTRY_STATS, statsPayload(id, r.stageId, s));
+    uint64_t end = 0;
+    if (!append(e, end)) return false;
+    return commit(end, 1);
+}
+
+bool UserStore::recordResult(int stageId, bool won, uint32_t moves, uint32_t timeMs)
+{
+    loadCache();
+    if (!cache.found || stageId < 0) return false;
+    Pending change;
+    change.results.push_back({ static_cast<uint32_t>(stageId), won, moves, timeMs });
+    markDirty(change);
+    return true;
+}
+
+bool UserStore::levelBoard(int stageId, size_t k, LevelStats& mine, size_t& rank, size_t& ranked,
+                           std::vector<Leaderboards::Standing>& top)
+{
+    loadCache();
+    if (!cache.found || stageId < 0) return false;
+    std::lock_guard<std::mutex> lock(boardsMutex);
+    if (!boardsLoaded) return false;
+    const uint32_t st = static_cast<uint32_t>(stageId);
+    mine = boards.get(cache.activeId, st);
+    rank = boards.rank(cache.activeId, st);
+    ranked = boards.ranked(st);
+    boards.top(st, k, top);
+    return true;
+}
+
+void UserStore::flush()
+{
+    std::unique_lock<std::mutex> lock(writerMutex);
+    if (!pending.any() && !writing) return;
+    flushRequested = true;
+    writerWake.notify_all();
+    writerIdle.wait(lock, [this] { return !pending.any() && !writing; });
+    flushRequested = false;
+}
+
+void UserStore::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        writerRunning = false;
+        stopped = true;
+        writerWake.notify_all();
+    }
+    // the writer drains what is pending before it exits
+    if (writer.joinable()) writer.join();
+}
+
+// ---------- accounts ----------
+
+void UserStore::loadCache()
+{
+    if (cache.loaded) return;
+    {
+        std::lock_guard<std::mutex> io(ioMutex);
+        cache = Cache();
+        cache.loaded = true;
+        cache.hasFile = open();
+        if (!cache.hasFile) return;
+        const IndexHeader* h = header();
+        cache.signedOut = h->sign != 0;
+        if (h->activeSlot != NO_SLOT && readAccount(slots()[h->activeSlot].offset, cache.active)) {
+            cache.active.progress = slots()[h->activeSlot].progress;
+            cache.activeId = slots()[h->activeSlot].id;
+            cache.found = true;
+        }
+    }
+    // leaderboards: one replay, on the writer, long before a level can be cleared
+    Pending change;
+    change.loadBoards = true;
+    markDirty(change);
+}
+
+bool UserStore::hasFile()
+{
+    loadCache();
+    return cache.hasFile;
+}
+
+bool UserStore::session(Record& out, bool& signedOut)
+{
+    loadCache();
+    signedOut = cache.signedOut;
+    if (!cache.found) return false;
+    out = cache.active;
+    return true;
+}
+
+bool UserStore::exists(const std::string& user)
+{
+    std::lock_guard<std::mutex> io(ioMutex);
+    return open() && findSlot(user, nullptr, nullptr) != NO_SLOT;
+}
+
+bool UserStore::login(const std::string& user, const std::string& pass, Record& out)
+{
+    flush(); // changes of the previous account go to the previous account
+    std::lock_guard<std::mutex> io(ioMutex);
+    if (!open()) return false;
+    const uint32_t slot = findSlot(user, &pass, &out);
+    if (slot == NO_SLOT) return false;
+    const uint32_t id = slots()[slot].id;
+    const IndexHeader* h = header();
+    if ((h->activeSlot != slot || h->sign != 0) && !appendSession(0, slot)) return false;
+
+    cache.loaded = cache.hasFile = cache.found = true;
+    cache.active = out;
+    cache.activeId = id;
+    cache.signedOut = false;
+    return true;
+}
+
+bool UserStore::signin(const std::string& user, const std::string& pass, Record& out)
+{
+    flush();
+    std::lock_guard<std::mutex> io(ioMutex);
+    if (!open() && !createEmpty()) return false;
+    if (findSlot(user, nullptr, nullptr) != NO_SLOT) {
+        std::cerr << "UserStore::signin - username already exists: " << user << "\n";
+        return false;
+    }
+    if ((header()->count + 1) * 2 > header()->capacity && !grow()) return false;
+
+    IndexHeader* h = header();
+    if (h->journalBytes > 0xFFFF0000u) {
+        // offsets are 32-bit; a journal this large has to be compacted first
+        if (!rewrite()) return false;
+        h = header();
+    }
+    Record r;
+    r.username = user;
+    r.password = pass;
+    const uint32_t id = h->nextId;
+    const uint32_t offset = static_cast<uint32_t>(h->journalBytes);
+    std::string e;
+    encodeEntry(e, ENTRY_ACCOUNT, accountPayload(r));
+    encodeEntry(e, ENTRY_SESSION, sessionPayload(0, static_cast<int32_t>(id)));
+    uint64_t end = 0;
+    if (!append(e, end)) return false;
+
+    uint32_t at = NO_SLOT;
+    insertSlot(hashName(user), offset, id, 0, &at);
+    h->nextId = id + 1;
+    {
+        std::lock_guard<std::mutex> lock(boardsMutex);
+        if (boardsLoaded) boards.setName(id, user);
+    }
+    h->activeSlot = at;
+    h->sign = 0;
+    out = r;
+    cache.loaded = cache.hasFile = cache.found = true;
+    cache.active = r;
+    cache.activeId = id;
+    cache.signedOut = false;
+    return commit(end, 2);
+}
+
+bool UserStore::setSignedOut(bool signedOut)
+{
+    loadCache();
+    if (!cache.hasFile) return false;
+    if (cache.signedOut == signedOut) return true;
+    cache.signedOut = signedOut;
+    Pending change;
+    change.sign = true;
+    change.signedOut = signedOut;
+    markDirty(change);
+    return true;
+}
+
+bool UserStore::setProgress(int32_t progress)
+{
+    loadCache();
+    if (!cache.found) {
+        std::cerr << "UserStore::setProgress - no active account\n";
+        return false;
+    }
+    if (cache.active.progress == progress) return true;
+    cache.active.progress = progress;
+    Pending change;
+    change.progress = true;
+    change.progressValue = progress;
+    markDirty(change);
+    return true;
+}
+
+void UserStore::requestCompact()
+{
+    Pending change;
+    change.compact = true;
+    markDirty(change);
+}
+
+std::vector<UserStore::Record> UserStore::loadAll()
+{
+    flush();
+    std::lock_guard<std::mutex> io(ioMutex);
+    Replay state;
+    if (!open() || !readJournal(state)) return {};
+    return state.records;
+}
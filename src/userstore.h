@@ -0,0 +1,259 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include "assets.h" // MappedFile
+#include "leaderboard.h"
+
+// Account storage behind User, one per file for the whole process (Start and Game share it).
+//
+// users.bin is a journal and the source of truth: "MMUS", u32 version, then entries
+//   u8 kind, u32 size, payload[size], u32 crc32 (of kind, size and payload)
+// Account  { str username, str password, i32 progress }  id = number of Account entries before it
+// Progress { u32 id, i32 progress }
+// Session  { u8 sign, i32 active id (-1 = none) }
+// Stats    { u32 id, u32 stage id, u32 bestMoves, u32 bestTimeMs, u32 attempts }  latest wins
+//          (kind 5; keyed by StageInfo::id so reordering the catalog keeps the results. Kind 4,
+//          the same payload keyed by catalog index, only came from pre-release builds and is skipped)
+// Boards   { u32 accounts before it, u32 rows, rows x Stats payload,
+//            u32 names, names x { u32 id, str username } }  (kind 6, version 4)
+//          every stats row at compaction time and the names of the accounts in them, so the
+//          leaderboards load from it and the entries after it, not from a replay
+// (str = u32 length + bytes). A change appends one entry (clearing a stage writes 17 bytes,
+// its result 29). A replay stops at the first entry that is cut off or fails its crc, which
+// is what a crash in the middle of an append leaves; the damaged tail is dropped. Once there
+// are COMPACT_SLACK more entries than a compacted journal would hold (one per account, the
+// Boards entry and the session) the writer compacts it at the end of a batch: the snapshot
+// goes to users.bin.tmp which is then renamed over users.bin, so a crash leaves either the
+// old or the new file. A version 3 journal (no Boards entry) is read as is and compacted
+// into version 4 by the first batch of the writer.
+// Version 2 ("MMUS", u32 2, u8 sign, u64 count, records with u64 string lengths) and the
+// older layout without magic (records end with a stage char) are converted when opened.
+//
+// users.idx is a memory-mapped open-addressing hash table on the username, so login and the
+// duplicate check of signin probe a few slots and read only the matching Account entry, from a
+// read-only mapping of users.bin (mapped again only when that entry was appended after it);
+// no profile is read before it is used, whatever the number of accounts. tools/bench_userstore
+// times this path.
+//   header : "MMIX", u32 version, u32 capacity (power of 2), u32 count, u64 journalBytes,
+//            u32 activeSlot (~0 = none), u32 nextId, u32 entries, u32 baseEntries (entries
+//            right after a compaction), u32 boardsOffset (last Boards entry, 0 = none),
+//            u8 sign, padding to 64 bytes
+//   slots  : capacity x { u32 hash (0 = empty), u32 offset of the Account entry, u32 id, i32 progress }
+// The index is only a cache of the journal: journalBytes must equal the size of users.bin,
+// otherwise (missing, older build, crash between the two writes) one full replay rebuilds it.
+// A change marks the index stale, appends to the journal, updates the slots and then stores
+// the new journalBytes.
+//
+// The active account is cached in memory and the cache is what the game reads and changes:
+// after the first load, hasFile()/session() never touch the disk, and setProgress() /
+// setSignedOut() only update the cache and mark it dirty. A writer thread appends the dirty
+// state a moment later, so several changes in a row become one write of the latest values.
+// login/signin (menu only) flush first and then work on the files directly. flush() waits
+// for the writer; shutdownAll() on quit flushes and stops it.
+//
+// Per-level results (LevelStats) of every account are kept in Leaderboards, which the writer
+// loads in the background after the cache is first used: the Boards entry at boardsOffset
+// plus the fewer than COMPACT_SLACK entries after it (a replay only without one). recordResult()
+// only queues the run; the writer merges it, appends a Stats entry and bumps boardVersion(),
+// and levelBoard() then answers stats, rank and top k from memory.
+class UserStore {
+public:
+    struct Record {
+        std::string username;
+        std::string password;
+        int32_t progress = 0; // stages cleared in catalog order
+    };
+
+    static const uint32_t FILE_VERSION = 4; // 4: Boards entry
+    static const uint32_t INDEX_VERSION = 3; // 3: boardsOffset
+    static const uint32_t MIN_CAPACITY = 64;
+    static const size_t COMPACT_SLACK = 256;
+    static const int COALESCE_MS = 200; // writer waits this long for more changes before writing
+
+    static UserStore& get(const std::string& path);
+    // flush and stop the writer of every store (on quit)
+    static void shutdownAll();
+
+    ~UserStore();
+    UserStore(const UserStore&) = delete;
+    UserStore& operator=(const UserStore&) = delete;
+
+    // users.bin exists and holds accounts (cached; converted / index rebuilt on first use)
+    bool hasFile();
+    // profile of the last session and its logout flag; false when there is none (cached)
+    bool session(Record& out, bool& signedOut);
+
+    // check the password, make the account active and clear the logout flag
+    bool login(const std::string& user, const std::string& pass, Record& out);
+    // new active account; false when the name is taken
+    bool signin(const std::string& user, const std::string& pass, Record& out);
+    bool exists(const std::string& user);
+
+    // write-behind: the cache changes now, the writer thread persists it
+    bool setSignedOut(bool signedOut);
+    bool setProgress(int32_t progress); // of the active account
+    // rewrite the journal with one entry per account and rebuild the index
+    void requestCompact();
+
+    // block until every change made so far is on disk
+    void flush();
+    // flush and stop the writer; later changes are written synchronously
+    void shutdown();
+
+    // a finished run of the active account on the stage with StageInfo::id `stageId`; never
+    // waits for the disk. Dropped (logged) if the leaderboards could not be loaded, since the
+    // merged entry would overwrite the saved stats with this run alone
+    bool recordResult(int stageId, bool won, uint32_t moves, uint32_t timeMs);
+    // stats of the active account on `stageId`, its rank there (1 = best, 0 = not cleared), how
+    // many accounts cleared it and the best `k`; false while the leaderboards are still loading
+    bool levelBoard(int stageId, size_t k, LevelStats& mine, size_t& rank, size_t& ranked,
+                    std::vector<Leaderboards::Standing>& top);
+    // changes whenever a result has been merged (cheap to poll every frame)
+    uint64_t boardVersion() const { return boardsVersion.load(std::memory_order_acquire); }
+
+    // every account, by full replay (tools)
+    std::vector<Record> loadAll();
+    // flush, unmap the index and the journal and forget the cache (next call loads again)
+    void close();
+
+private:
+    struct IndexHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t capacity;
+        uint32_t count;
+        uint64_t journalBytes;
+        uint32_t activeSlot;
+        uint32_t nextId;
+        uint32_t entries;
+        uint32_t baseEntries;
+        uint32_t boardsOffset;
+        uint8_t sign;
+        uint8_t pad[19];
+    };
+    struct Slot {
+        uint32_t hash;
+        uint32_t offset;
+        uint32_t id;
+        int32_t progress;
+    };
+    // what a full replay of the journal yields
+    struct Replay {
+        std::vector<Record> records;
+        std::vector<uint32_t> offsets; // of each Account entry
+        uint8_t sign = 0;
+        int32_t active = -1;
+        std::unordered_map<uint64_t, LevelStats> stats; // (id << 32 | stage id)
+        uint32_t boardsOffset = 0;     // of the last Boards entry
+        uint32_t entries = 0;
+        uint64_t goodBytes = 0;        // end of the last intact entry
+        uint64_t fileBytes = 0;
+    };
+
+    static const uint32_t NO_SLOT = 0xFFFFFFFFu;
+    static const uint64_t STALE = ~0ull;
+
+    // active account as the game sees it; main thread only
+    struct Cache {
+        bool loaded = false;
+        bool hasFile = false;
+        bool found = false; // there is an active account
+        Record active;
+        uint32_t activeId = 0;
+        bool signedOut = false;
+    };
+    struct Result {
+        uint32_t stageId;
+        bool won;
+        uint32_t moves;
+        uint32_t timeMs;
+    };
+    // changes not written yet; a newer value replaces an older one, results are all kept
+    struct Pending {
+        bool progress = false;
+        int32_t progressValue = 0;
+        bool sign = false;
+        bool signedOut = false;
+        bool compact = false;
+        bool loadBoards = false;
+        std::vector<Result> results;
+        bool any() const { return progress || sign || compact || loadBoards || !results.empty(); }
+    };
+
+    explicit UserStore(const std::string& path);
+
+    std::string path;
+    std::string indexPath;
+    MappedFile index;
+    // read-only view of users.bin for readAccount(); opened again when an entry lies past
+    // its end (appended since), closed before a compaction renames the file
+    MappedFile journalView;
+    std::mutex ioMutex; // files + index: main thread (load, login, signin) vs writer
+
+    Cache cache;
+    void loadCache();
+
+    // writer thread
+    std::thread writer;
+    std::mutex writerMutex;
+    std::condition_variable writerWake;
+    std::condition_variable writerIdle;
+    Pending pending;             // guarded by writerMutex, like the flags below
+    bool writing = false;
+    bool writerRunning = false;
+    bool flushRequested = false;
+    bool stopped = false;        // after shutdown(): no writer, markDirty writes inline
+    void markDirty(const Pending& change);
+    void startWriter(); // writerMutex held
+    void writerMain();
+    void apply(const Pending& work); // ioMutex held
+
+    // leaderboards: built and merged by the writer, read by the main thread
+    std::mutex boardsMutex;
+    Leaderboards boards;
+    bool boardsLoaded = false;   // guarded by boardsMutex
+    std::atomic<uint64_t> boardsVersion{ 0 };
+    void loadBoards();           // ioMutex held
+    bool readBoards(Leaderboards& out); // ioMutex held
+    bool writeResult(const Result& r); // ioMutex held
+
+    IndexHeader* header() const { return reinterpret_cast<IndexHeader*>(index.writableData()); }
+    Slot* slots() const { return reinterpret_cast<Slot*>(index.writableData() + sizeof(IndexHeader)); }
+
+    bool open();
+    bool createEmpty();
+    bool rebuild();
+    bool convert(const std::string& data);
+    bool readJournal(Replay& out);
+    bool writeJournal(Replay& state);
+    bool writeIndex(const Replay& state);
+    bool createIndex(uint32_t capacity);
+    bool grow();
+    void insertSlot(uint32_t hash, uint32_t offset, uint32_t id, int32_t progress, uint32_t* at = nullptr);
+    // first account named `user` (and with password `pass` when given); NO_SLOT if none.
+    // Old files may hold the same name twice, so login checks every match.
+    uint32_t findSlot(const std::string& user, const std::string* pass, Record* out);
+    bool readAccount(uint32_t offset, Record& out);
+    // journalView covers at least the first `end` bytes of users.bin
+    bool mapJournal(uint64_t end);
+
+    // append already encoded entries; the index stays stale until commit()
+    bool append(const std::string& entries, uint64_t& endBytes);
+    // appends are synced to the disk one by one, except inside apply(): the writer syncs once
+    // per batch (ioMutex held for both)
+    bool batching = false;
+    bool unsyncedAppends = false;
+    bool syncJournal();
+    // the index is valid again; queues a compaction on the writer once it is due
+    bool commit(uint64_t journalBytes, uint32_t count);
+    bool compactDue() const;
+    bool appendSession(uint8_t sign, uint32_t slot);
+    bool writeProgress(int32_t progress);
+    bool writeSignedOut(bool signedOut);
+    bool rewrite();
+};
@@ -0,0 +1,90 @@
+// Benchmark for UserStore (src/userstore.h): creates N accounts in a scratch users.bin,
+// then times login() (index probe + account read through the mapped journal, with and
+// without the Session entry a switch of account appends), exists() on absent names and
+// the first hasFile() after reopening (index map).
+// Links the store itself, so it measures the code the game runs.
+// usage: bench_userstore [accounts=100000] [logins=20000] [dir=bench_users]
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include "../src/userstore.h"
+
+static double elapsedUs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    const int accounts = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int logins = argc > 2 ? std::atoi(argv[2]) : 20000;
+    const std::string dir = argc > 3 ? argv[3] : "bench_users";
+    if (accounts <= 0 || logins <= 0) {
+        std::cerr << "usage: bench_userstore [accounts] [logins] [dir]\n";
+        return 1;
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir, ec);
+    const std::string path = dir + "/users.bin";
+    UserStore& store = UserStore::get(path);
+
+    auto start = std::chrono::steady_clock::now();
+    UserStore::Record rec;
+    for (int i = 0; i < accounts; ++i) {
+        if (!store.signin("user" + std::to_string(i), "pass" + std::to_string(i), rec)) {
+            std::cerr << "signin failed at " << i << "\n";
+            return 1;
+        }
+    }
+    store.flush();
+    std::cout << accounts << " accounts created in " << elapsedUs(start) / 1e6 << " s, users.bin "
+              << std::filesystem::file_size(path, ec) / 1024 << " KB\n";
+
+    // cold: the index and the journal view are mapped again
+    store.close();
+    start = std::chrono::steady_clock::now();
+    store.hasFile();
+    std::cout << "reopen (hasFile): " << elapsedUs(start) << " us\n";
+
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> pick(0, accounts - 1);
+    int failed = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < logins; ++i) {
+        const int n = pick(rng);
+        if (!store.login("user" + std::to_string(n), "pass" + std::to_string(n), rec)) ++failed;
+    }
+    const double loginUs = elapsedUs(start) / logins;
+    store.flush();
+
+    // the account is already active: no Session entry is appended, only probe + read
+    const int n = pick(rng);
+    const std::string user = "user" + std::to_string(n), pass = "pass" + std::to_string(n);
+    store.login(user, pass, rec);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < logins; ++i) {
+        if (!store.login(user, pass, rec)) ++failed;
+    }
+    const double readUs = elapsedUs(start) / logins;
+
+    int missing = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < logins; ++i) {
+        if (!store.exists("nobody" + std::to_string(i))) ++missing;
+    }
+    const double existsUs = elapsedUs(start) / logins;
+
+    std::cout << "login (switch account, appends a Session entry): " << loginUs << " us avg over " << logins << "\n"
+              << "login (active account, read only): " << readUs << " us avg (" << failed << " failed)\n"
+              << "exists (absent name): " << existsUs << " us avg (" << missing << " absent)\n";
+
+    UserStore::shutdownAll();
+    store.close();
+    std::filesystem::remove_all(dir, ec);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+// Build-time packer for assets.pak (format documented in src/assets.h).
+// usage: pack_assets <assets dir> <output.pak>
+// Run from the game's working directory so packed paths match the ones the game
+// asks for, e.g. "assets/images/title.png".
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const uint32_t PACK_VERSION = 2;
+static const uint32_t PACK_ALIGN = 64;
+
+struct PackEntry {
+    uint64_t pathHash;
+    uint32_t pathOffset;
+    uint32_t pathLength;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+    uint64_t dataHash;
+};
+
+// content id of an entry (the game keys caches on it instead of hashing the bytes again)
+static uint64_t hashBytes(const char* p, size_t size)
+{
+    uint64_t h = 1469598103934665603ull ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        h = (h ^ w) * 1099511628211ull;
+    }
+    for (; i < size; ++i) h = (h ^ static_cast<uint8_t>(p[i])) * 1099511628211ull;
+    return h;
+}
+
+// must match Assets::hashPath
+static uint64_t hashPath(const std::string& path)
+{
+    uint64_t h = 1469598103934665603ull;
+    for (char c : path) {
+        h ^= static_cast<uint8_t>(c == '\\' ? '/' : c);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static uint64_t alignUp(uint64_t v) { return (v + PACK_ALIGN - 1) / PACK_ALIGN * PACK_ALIGN; }
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        std::cerr << "usage: pack_assets <assets dir> <output.pak>\n";
+        return 1;
+    }
+
+    struct Item { std::string path; fs::path file; uint64_t size; };
+    std::vector<Item> items;
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(argv[1], ec); it != fs::recursive_directory_iterator(); ++it) {
+        if (!it->is_regular_file()) continue;
+        std::string key = it->path().generic_string();
+        if (key.rfind("./", 0) == 0) key.erase(0, 2);
+        items.push_back({ key, it->path(), static_cast<uint64_t>(it->file_size()) });
+    }
+    if (ec || items.empty()) {
+        std::cerr << "pack_assets: nothing to pack in " << argv[1] << "\n";
+        return 1;
+    }
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        uint64_t ha = hashPath(a.path), hb = hashPath(b.path);
+        return ha != hb ? ha < hb : a.path < b.path;
+    });
+
+    // layout: header, toc, strings, aligned data
+    const uint32_t count = static_cast<uint32_t>(items.size());
+    std::vector<PackEntry> toc(count);
+    std::string strings;
+    uint64_t stringsStart = 16 + static_cast<uint64_t>(count) * sizeof(PackEntry);
+    for (uint32_t i = 0; i < count; ++i) {
+        toc[i].pathHash = hashPath(items[i].path);
+        toc[i].pathOffset = static_cast<uint32_t>(stringsStart + strings.size());
+        toc[i].pathLength = static_cast<uint32_t>(items[i].path.size());
+        strings += items[i].path;
+    }
+    uint64_t cursor = alignUp(stringsStart + strings.size());
+    for (uint32_t i = 0; i < count; ++i) {
+        toc[i].dataOffset = cursor;
+        toc[i].dataSize = items[i].size;
+        cursor = alignUp(cursor + items[i].size);
+    }
+
+    std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "pack_assets: cannot write " << argv[2] << "\n";
+        return 1;
+    }
+    const uint32_t reserved = 0;
+    out.write("MMPK", 4);
+    out.write(reinterpret_cast<const char*>(&PACK_VERSION), 4);
+    out.write(reinterpret_cast<const char*>(&count), 4);
+    out.write(reinterpret_cast<const char*>(&reserved), 4);
+    out.write(reinterpret_cast<const char*>(toc.data()), static_cast<std::streamsize>(toc.size() * sizeof(PackEntry)));
+    out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+
+    std::vector<char> buf;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint64_t pos = static_cast<uint64_t>(out.tellp());
+        if (pos < toc[i].dataOffset) {
+            std::vector<char> pad(static_cast<size_t>(toc[i].dataOffset - pos), 0);
+            out.write(pad.data(), static_cast<std::streamsize>(pad.size()));
+        }
+        std::ifstream in(items[i].file, std::ios::binary);
+        buf.assign(static_cast<size_t>(items[i].size), 0);
+        if (!in.read(buf.data(), static_cast<std::streamsize>(buf.size()))) {
+            std::cerr << "pack_assets: failed to read " << items[i].file << "\n";
+            return 1;
+        }
+        out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        toc[i].dataHash = hashBytes(buf.data(), buf.size());
+    }
+    // the hashes are known once the data has been read: write the toc again
+    out.seekp(16);
+    out.write(reinterpret_cast<const char*>(toc.data()), static_cast<std::streamsize>(toc.size() * sizeof(PackEntry)));
+    out.seekp(0, std::ios::end);
+    if (!out) {
+        std::cerr << "pack_assets: write failed\n";
+        return 1;
+    }
+    std::cout << "pack_assets: " << count << " files -> " << argv[2] << " (" << out.tellp() << " bytes)\n";
+    return 0;
+}
@@ -0,0 +1,152 @@
+// Build-time converter: 16-bit PCM WAV -> IMA-ADPCM WAV (about 4x smaller), the
+// compressed format MusicStream (src/music.h) streams music from.
+// usage: wav_adpcm <input.wav> <output.wav>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static const int BLOCK_BYTES_PER_CHANNEL = 512;
+
+static const int IMA_INDEX[16] = { -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8 };
+static const int IMA_STEP[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+struct ImaState {
+    int predictor = 0;
+    int index = 0;
+};
+
+// same arithmetic as the decoder, so encoder and decoder predictors never drift
+static int encodeSample(int sample, ImaState& st)
+{
+    const int step = IMA_STEP[st.index];
+    int diff = sample - st.predictor;
+    int nibble = 0;
+    if (diff < 0) { nibble = 8; diff = -diff; }
+    if (diff >= step) { nibble |= 4; diff -= step; }
+    if (diff >= step >> 1) { nibble |= 2; diff -= step >> 1; }
+    if (diff >= step >> 2) nibble |= 1;
+
+    int delta = step >> 3;
+    if (nibble & 4) delta += step;
+    if (nibble & 2) delta += step >> 1;
+    if (nibble & 1) delta += step >> 2;
+    st.predictor += (nibble & 8) ? -delta : delta;
+    st.predictor = std::clamp(st.predictor, -32768, 32767);
+    st.index = std::clamp(st.index + IMA_INDEX[nibble], 0, 88);
+    return nibble;
+}
+
+static uint32_t readU32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24); }
+static uint16_t readU16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+static void putU32(std::vector<uint8_t>& o, uint32_t v) { for (int i = 0; i < 4; ++i) o.push_back(static_cast<uint8_t>(v >> (8 * i))); }
+static void putU16(std::vector<uint8_t>& o, uint16_t v) { o.push_back(static_cast<uint8_t>(v)); o.push_back(static_cast<uint8_t>(v >> 8)); }
+static void putTag(std::vector<uint8_t>& o, const char* t) { o.insert(o.end(), t, t + 4); }
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        std::cerr << "usage: wav_adpcm <input.wav> <output.wav>\n";
+        return 1;
+    }
+    std::ifstream in(argv[1], std::ios::binary);
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (file.size() < 12 || std::memcmp(file.data(), "RIFF", 4) != 0 || std::memcmp(file.data() + 8, "WAVE", 4) != 0) {
+        std::cerr << argv[1] << ": not a WAV file\n";
+        return 1;
+    }
+
+    int channels = 0, bits = 0, format = 0;
+    uint32_t rate = 0;
+    const int16_t* samples = nullptr;
+    size_t frames = 0;
+    for (size_t pos = 12; pos + 8 <= file.size();) {
+        const uint32_t size = readU32(file.data() + pos + 4);
+        const uint8_t* body = file.data() + pos + 8;
+        if (pos + 8 + size > file.size()) break;
+        if (std::memcmp(file.data() + pos, "fmt ", 4) == 0 && size >= 16) {
+            format = readU16(body);
+            channels = readU16(body + 2);
+            rate = readU32(body + 4);
+            bits = readU16(body + 14);
+        } else if (std::memcmp(file.data() + pos, "data", 4) == 0 && channels > 0) {
+            samples = reinterpret_cast<const int16_t*>(body);
+            frames = size / (2 * channels);
+        }
+        pos += 8 + size + (size & 1);
+    }
+    if (format != 1 || bits != 16 || channels < 1 || channels > 2 || !samples) {
+        std::cerr << argv[1] << ": need 16-bit PCM mono/stereo\n";
+        return 1;
+    }
+
+    const int blockAlign = BLOCK_BYTES_PER_CHANNEL * channels;
+    const int samplesPerBlock = (blockAlign - 4 * channels) * 2 / channels + 1;
+    const size_t blocks = (frames + samplesPerBlock - 1) / samplesPerBlock;
+
+    std::vector<uint8_t> data;
+    data.reserve(blocks * blockAlign);
+    ImaState st[2];
+    auto sampleAt = [&](size_t f, int c) -> int { return f < frames ? samples[f * channels + c] : 0; };
+    for (size_t b = 0; b < blocks; ++b) {
+        const size_t first = b * samplesPerBlock;
+        // header: the first sample verbatim + the running step index
+        for (int c = 0; c < channels; ++c) {
+            st[c].predictor = sampleAt(first, c);
+            putU16(data, static_cast<uint16_t>(static_cast<int16_t>(st[c].predictor)));
+            data.push_back(static_cast<uint8_t>(st[c].index));
+            data.push_back(0);
+        }
+        // per channel, 8 samples into 4 bytes, low nibble first
+        for (size_t f = first + 1; f < first + samplesPerBlock; f += 8) {
+            for (int c = 0; c < channels; ++c) {
+                for (int i = 0; i < 8; i += 2) {
+                    const int lo = encodeSample(sampleAt(f + i, c), st[c]);
+                    const int hi = encodeSample(sampleAt(f + i + 1, c), st[c]);
+                    data.push_back(static_cast<uint8_t>(lo | (hi << 4)));
+                }
+            }
+        }
+    }
+
+    std::vector<uint8_t> out;
+    putTag(out, "RIFF");
+    putU32(out, 0); // patched below
+    putTag(out, "WAVE");
+    putTag(out, "fmt ");
+    putU32(out, 20);
+    putU16(out, 0x0011);
+    putU16(out, static_cast<uint16_t>(channels));
+    putU32(out, rate);
+    putU32(out, static_cast<uint32_t>(static_cast<uint64_t>(rate) * blockAlign / samplesPerBlock));
+    putU16(out, static_cast<uint16_t>(blockAlign));
+    putU16(out, 4);
+    putU16(out, 2);
+    putU16(out, static_cast<uint16_t>(samplesPerBlock));
+    putTag(out, "fact");
+    putU32(out, 4);
+    putU32(out, static_cast<uint32_t>(frames)); // real length, the last block is padded
+    putTag(out, "data");
+    putU32(out, static_cast<uint32_t>(data.size()));
+    out.insert(out.end(), data.begin(), data.end());
+    const uint32_t riffSize = static_cast<uint32_t>(out.size() - 8);
+    std::memcpy(out.data() + 4, &riffSize, 4);
+
+    std::ofstream o(argv[2], std::ios::binary);
+    o.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+    if (!o) {
+        std::cerr << argv[2] << ": write failed\n";
+        return 1;
+    }
+    std::cerr << argv[1] << ": " << frames << " frames, " << file.size() << " -> " << out.size() << " bytes\n";
+    return 0;
+}